@@ -0,0 +1,34 @@
+// Console output speed: "consbench [lines]" writes lines (default
+// 1000) of 79 characters to the console, one write() per line, and
+// prints the bytes per second.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+char line[80];
+
+int
+main(int argc, char *argv[])
+{
+  int i, n, t;
+
+  n = 1000;
+  if(argc > 1)
+    n = atoi(argv[1]);
+  for(i = 0; i < 79; i++)
+    line[i] = 'a' + i % 26;
+  line[79] = '\n';
+
+  t = uptime();
+  for(i = 0; i < n; i++)
+    write(1, line, sizeof(line));
+  t = uptime() - t;
+
+  // Ticks are 10ms.
+  printf(1, "consbench: %d bytes in %d ticks", n*sizeof(line), t);
+  if(t > 0)
+    printf(1, ", %d bytes/s", n*sizeof(line)*100/t);
+  printf(1, "\n");
+  exit();
+}
@@ -14,14 +14,19 @@
 #include "mmu.h"
 #include "proc.h"
 #include "x86.h"
+#include "ioctl.h"
 
 static void consputc(int);
+static void consflush(void);
 
 static int panicked = 0;
 
 static struct {
   struct spinlock lock;
   int locking;
+  int raw;       // pass keys straight to consoleread() (see ioctl.h)
+  char tx[128];  // bytes for the UART, sent by consflush()
+  int ntx;
 } cons;
 
 static void
@@ -99,6 +104,7 @@ cprintf(char *fmt, ...)
     }
   }
 
+  consflush();
   if(locking)
     release(&cons.lock);
 }
@@ -118,6 +124,7 @@ panic(char *s)
   getcallerpcs(&s, pcs);
   for(i=0; i<10; i++)
     cprintf(" %p", pcs[i]);
+  uartflush();
   panicked = 1; // freeze other CPU
   for(;;)
     ;
@@ -125,18 +132,96 @@ panic(char *s)
 
 //PAGEBREAK: 50
 
+// The screen is a window of 25 rows onto the CGA memory, starting
+// at word crttop. Scrolling moves the window down a row by setting
+// the CRTC start address instead of copying the screen; only when
+// the window reaches the end of the memory is the screen copied
+// back to the top. The cursor is kept in crtpos and given to the
+// CRTC by cgasync(), once per console write rather than per char.
+#define CRTWORDS 8192  // 16KB of CGA text memory
+
 static ushort *crt = (ushort*)P2V(0xb8000);  // CGA memory
+static int crttop;         // word at the top left of the screen
+static int crtpos = -1;    // cursor: col + 80*row on the screen
+static int crtsynced;      // CRTC start and cursor are up to date
+static int crtesc;         // in an escape: 1 after ESC, 2 after ESC [
+static int crtarg;         // the escape's numeric argument
 
+// Tell the CRTC where the screen starts and where the cursor is.
 static void
-cgaputc(int c)
+cgasync(void)
 {
   int pos;
 
-  // Cursor position: col + 80*row.
+  if(crtsynced)
+    return;
+  outb(CRTPORT, 12);
+  outb(CRTPORT+1, crttop>>8);
+  outb(CRTPORT, 13);
+  outb(CRTPORT+1, crttop);
+  pos = crttop + crtpos;
   outb(CRTPORT, 14);
-  pos = inb(CRTPORT+1) << 8;
+  outb(CRTPORT+1, pos>>8);
   outb(CRTPORT, 15);
-  pos |= inb(CRTPORT+1);
+  outb(CRTPORT+1, pos);
+  crtsynced = 1;
+}
+
+// Carry out c, part of an ANSI escape sequence, on the screen.
+// Knows cursor forward (ESC [ n C) and back (ESC [ n D), which
+// wrap across rows, and erase to end of row (ESC [ K).
+static void
+cgaesc(int c)
+{
+  int n;
+
+  if(c == ESC){
+    crtesc = 1;
+    return;
+  }
+  if(crtesc == 1){
+    crtesc = c == '[' ? 2 : 0;
+    crtarg = 0;
+    return;
+  }
+  if(c >= '0' && c <= '9'){
+    if(crtarg < 25*80)
+      crtarg = crtarg*10 + c - '0';
+    return;
+  }
+  crtesc = 0;
+  n = crtarg > 0 ? crtarg : 1;
+  switch(c){
+  case 'C':
+    crtpos = crtpos + n < 24*80 ? crtpos + n : 24*80 - 1;
+    break;
+  case 'D':
+    crtpos = crtpos > n ? crtpos - n : 0;
+    break;
+  case 'K':
+    memset(crt + crttop + crtpos, 0, sizeof(crt[0])*(80 - crtpos%80));
+    break;
+  }
+  crtsynced = 0;
+}
+
+static void
+cgaputc(int c)
+{
+  int pos;
+
+  if(crtpos < 0){
+    // Pick up the cursor where the boot loader left it.
+    outb(CRTPORT, 14);
+    crtpos = inb(CRTPORT+1) << 8;
+    outb(CRTPORT, 15);
+    crtpos |= inb(CRTPORT+1);
+  }
+  if(c == ESC || crtesc){
+    cgaesc(c);
+    return;
+  }
+  pos = crtpos;
 
   switch(c) {
     case '\n':
@@ -149,24 +234,48 @@ cgaputc(int c)
       if(pos > 0) --pos;
       break;
     default:
-      crt[pos++] = (c&0xff) | 0x0700;  // black on white
+      crt[crttop + pos++] = (c&0xff) | 0x0700;  // black on white
   }
 
   if(pos < 0 || pos > 25*80)
     panic("pos under/overflow");
 
   if((pos/80) >= 24){  // Scroll up.
-    memmove(crt, crt+80, sizeof(crt[0])*23*80); 
     pos -= 80;
-    memset(crt+pos, 0, sizeof(crt[0])*(24*80 - pos));
+    crttop += 80;
+    if(crttop + 25*80 > CRTWORDS){
+      memmove(crt, crt+crttop, sizeof(crt[0])*pos);
+      crttop = 0;
+    }
+    memset(crt+crttop+pos, 0, sizeof(crt[0])*(25*80 - pos));
   }
 
-  outb(CRTPORT, 14);
-  outb(CRTPORT+1, pos>>8);
-  outb(CRTPORT, 15);
-  outb(CRTPORT+1, pos);
+  crtpos = pos;
+  crtsynced = 0;
   if (c == BACKSPACE)
-    crt[pos] = ' ' | 0x0700;
+    crt[crttop + pos] = ' ' | 0x0700;
+}
+
+// Queue c for the UART.
+static void
+constx(int c)
+{
+  if(cons.ntx == sizeof(cons.tx)){
+    uartwrite(cons.tx, cons.ntx);
+    cons.ntx = 0;
+  }
+  cons.tx[cons.ntx++] = c;
+}
+
+// Send what consputc() has queued for the UART in one go, and the
+// cursor to the CRTC. Called once per write, cprintf() or batch of
+// keystrokes, so that a whole redraw goes out together.
+static void
+consflush(void)
+{
+  uartwrite(cons.tx, cons.ntx);
+  cons.ntx = 0;
+  cgasync();
 }
 
 void
@@ -180,320 +289,215 @@ consputc(int c)
 
   switch (c) {
     case BACKSPACE:
-      uartputc('\b'); uartputc(' '); uartputc('\b');  // uart is writing to the linux shell
+      constx('\b'); constx(' '); constx('\b');  // uart is writing to the linux shell
       break;
     case LEFT_ARROW:
-      uartputc('\b');
+      constx('\b');
       break;
     default:
-      uartputc(c);
+      constx(c);
   }
   cgaputc(c);
-  // uartputc prints to Linux's terminal and cgaputc prints to QEMU's terminal
+  // the uart prints to Linux's terminal and cgaputc prints to QEMU's terminal
 }
 
+// Committed input, waiting for consoleread().
 struct {
-  char buf[INPUT_BUF];
+  char buf[LINE_BUF];
   uint r;  // Read index
   uint w;  // Write index
-  uint e;  // Edit index
-  uint rightmost; // the first empty char in the line
 } input;
 
-// stores the charactes in the input which have to be shifted while backspacing and typing while caret is not at the end.
-char buffToBeShifted[INPUT_BUF]; 
-
-// this struct stores the commands and its details.
+// The line being edited, in a gap buffer: the text is buf[0..gs)
+// followed by buf[ge..LINE_BUF), with the caret at gs, so typing,
+// deleting and moving the caret take constant time. After each
+// batch of keys lineredraw() brings the screen up to date, starting
+// from the first character that changed and moving the caret with
+// ANSI escapes rather than repainting the rest of the line.
 struct {
-  char CommandMemArr[MAX_HISTORY][INPUT_BUF];   // holds the actual command strings.
-  uint lengthsArr[MAX_HISTORY];                 // this will hold the length of each command string.
-  uint FinalCMdIndex;                          // the index of the last command entered to history.
-  int TotalCMDsInMem;                           // total number of commands executed from the system boot.
-  int currentPosition;                          // no. of skips in history array while toggling up and down arrow.
-} HistoryMem;
+  char buf[LINE_BUF];
+  uint gs;     // start of the gap: the caret
+  uint ge;     // end of the gap
+  uint dirty;  // first position changed since the last redraw
+  uint shown;  // characters of the line on the screen
+  uint scur;   // caret position on the screen
+} line;
 
-char oldBuf[INPUT_BUF]; // this will hold the details of the command that was written before accessing the history
-uint lengthOfOldBuf;
+#define C(x)  ((x)-'@')  // Control-x
 
-char buf2[INPUT_BUF];
+// Length of the line being edited.
+static uint
+linelen(void)
+{
+  return line.gs + LINE_BUF - line.ge;
+}
 
-#define C(x)  ((x)-'@')  // Control-x
+// Character i of the line being edited.
+static int
+linechar(uint i)
+{
+  if(i < line.gs)
+    return line.buf[i];
+  return line.buf[line.ge + i - line.gs];
+}
 
-// copies the contents which have to be shifted from input to bufftoshifted 
-void copybuffToBeShifted() {
-  uint n = input.rightmost - input.e; // contents after edit have to be shifted when typed or backspaced.
-  uint i;
-  for (i = 0; i < n; i++)
-    buffToBeShifted[i] = input.buf[(input.e + i) % INPUT_BUF];
+// The longest the line may get: what fits in the input queue
+// along with the line's terminator.
+static uint
+linemax(void)
+{
+  return LINE_BUF - 1 - (input.w - input.r);
 }
 
-// shifts the input to right by one position and repaints it on the line on the screen from edit index and brings back caret to the original position
-void shiftbufright() {
-  uint n = input.rightmost - input.e;
-  int i;
-  for (i = 0; i < n; i++) {
+// Move the caret to position i of the line.
+static void
+linemove(uint i)
+{
+  while(line.gs > i)
+    line.buf[--line.ge] = line.buf[--line.gs];
+  while(line.gs < i && line.ge < LINE_BUF)
+    line.buf[line.gs++] = line.buf[line.ge++];
+}
 
-    char c = buffToBeShifted[i];
-    input.buf[(input.e + i) % INPUT_BUF] = c;
-    consputc(c); // repaitning the screen.
-  }
-  // reset buffToBeShifted for future use
-  memset(buffToBeShifted, '\0', INPUT_BUF);
-  // return the caret to its correct position
-  for (i = 0; i < n; i++) {
-    consputc(LEFT_ARROW);
-  }
+// Insert c at the caret.
+static void
+lineinsert(int c)
+{
+  if(linelen() >= linemax())
+    return;
+  if(line.dirty > line.gs)
+    line.dirty = line.gs;
+  line.buf[line.gs++] = c;
 }
 
-// Shift input.buf one positon to the left, and repaint the chars on-screen. Used only when punching in BACKSPACE and the caret isn't at the end of the line.
-void shiftbufleft() {
-  uint n = input.rightmost - input.e;
-  uint i;
-  consputc(LEFT_ARROW);
-  input.e--;
-  for (i = 0; i < n; i++) {
-    char c = input.buf[(input.e + i + 1) % INPUT_BUF];
-    input.buf[(input.e + i) % INPUT_BUF] = c;
-    consputc(c); // repainting the screen.
-  }
-  input.rightmost--;
-  consputc(' '); // delete the last char in line
-  for (i = 0; i <= n; i++) {
-    consputc(LEFT_ARROW); // shift the caret back to the left
+// Delete the n characters before the caret.
+static void
+linedelete(uint n)
+{
+  if(n > line.gs)
+    n = line.gs;
+  line.gs -= n;
+  if(line.dirty > line.gs)
+    line.dirty = line.gs;
+}
+
+// Move the caret on the screen n characters forward (dir 'C') or
+// back (dir 'D').
+static void
+linecursor(uint n, int dir)
+{
+  if(n == 0)
+    return;
+  consputc(ESC);
+  consputc('[');
+  printint(n, 10, 0);
+  consputc(dir);
+}
+
+// Bring the screen up to date with the line.
+static void
+lineredraw(void)
+{
+  uint i, d, len, cur;
+
+  len = linelen();
+  cur = line.scur;
+  d = line.dirty;
+  if(d > len)
+    d = len;
+  if(d < line.shown || d < len){
+    if(d < cur)
+      linecursor(cur - d, 'D');
+    else
+      linecursor(d - cur, 'C');
+    for(i = d; i < len; i++)
+      consputc(linechar(i));
+    for(; i < line.shown; i++)  // blank out what was deleted
+      consputc(' ');
+    cur = i;
   }
+  if(line.gs < cur)
+    linecursor(cur - line.gs, 'D');
+  else
+    linecursor(line.gs - cur, 'C');
+  line.shown = len;
+  line.scur = line.gs;
+  line.dirty = LINE_BUF;
+}
+
+// Hand the line, followed by c, to consoleread(), and start a new one.
+static void
+linecommit(int c)
+{
+  uint i, n;
+
+  linemove(linelen());
+  lineredraw();
+  consputc(c);
+  n = linelen();
+  for(i = 0; i < n; i++)
+    input.buf[input.w++ % LINE_BUF] = line.buf[i];
+  input.buf[input.w++ % LINE_BUF] = c;
+  line.gs = 0;
+  line.ge = LINE_BUF;
+  line.shown = 0;
+  line.scur = 0;
+  line.dirty = LINE_BUF;
+  wakeup(&input.r);
 }
 
 void
 consoleintr(int (*getc)(void))
 {
   int c, doprocdump = 0;
-  uint tempIndex;
   acquire(&cons.lock);
   while((c = getc()) >= 0){
+    if(cons.raw && c != C('P')){
+      if(input.w - input.r < LINE_BUF)
+        input.buf[input.w++ % LINE_BUF] = c == '\r' ? '\n' : c;
+      wakeup(&input.r);
+      continue;
+    }
     switch(c){
     	case C('P'):  // Process listing.
         doprocdump = 1;   // procdump() locks cons.lock indirectly; invoke later
         break;
-      case C('U'):  // Kill line.
-        if (input.rightmost > input.e) { // caret isn't at the end of the line
-          uint numtoshift = input.rightmost - input.e;
-          uint placestoshift = input.e - input.r;
-          uint i;
-          for (i = 0; i < placestoshift; i++) {
-            consputc(LEFT_ARROW);
-          }
-          memset(buf2, '\0', INPUT_BUF);
-          for (i = 0; i < numtoshift; i++) {
-            buf2[i] = input.buf[(input.r + i + placestoshift) % INPUT_BUF];
-          }
-          for (i = 0; i < numtoshift; i++) {
-            input.buf[(input.r + i) % INPUT_BUF] = buf2[i];
-          }
-          input.e -= placestoshift;
-          input.rightmost -= placestoshift;
-          for (i = 0; i < numtoshift; i++) { // repaint the chars
-            consputc(input.buf[(input.e + i) % INPUT_BUF]);
-          }
-          for (i = 0; i < placestoshift; i++) { // erase the leftover chars
-            consputc(' ');
-          }
-          for (i = 0; i < placestoshift + numtoshift; i++) { // move the caret back to the left
-            consputc(LEFT_ARROW);
-          }
-        }
-        else { // caret is at the end of the line -                                       ( deleting everything from both screen and inputbuf)
-          while(input.e != input.r &&
-                input.buf[(input.e - 1) % INPUT_BUF] != '\n'){ 
-            input.e--;
-            input.rightmost--;
-            consputc(BACKSPACE);
-          }
-        }
+      case C('U'):  // Kill line: everything before the caret.
+        linedelete(line.gs);
         break;
       case C('H'): case '\x7f':  // Backspace
-        if (input.rightmost != input.e && input.e != input.r) { // caret isn't at the end of the line
-          shiftbufleft(); // shifting buffer to one position left.
-          break;
-        }
-        if(input.e != input.r){ // caret is at the end of the line - deleting last char
-          input.e--;
-          input.rightmost--;
-          consputc(BACKSPACE);
-        }
+        linedelete(1);
         break;
       case LEFT_ARROW:
-        if (input.e != input.r) {
-          input.e--;
-          consputc(c);
-        }
+        if (line.gs > 0)
+          linemove(line.gs - 1);
         break;
       case RIGHT_ARROW:
-        if (input.e < input.rightmost) {
-          consputc(input.buf[input.e % INPUT_BUF]);
-          input.e++;
-        }
-        else if (input.e == input.rightmost){ // This line add the cursor at the end ogf the line. 
-          consputc(' ');
-          consputc(LEFT_ARROW);
-        }
+        linemove(line.gs + 1);
         break;
       case UP_ARROW:
-       if (HistoryMem.currentPosition < HistoryMem.TotalCMDsInMem-1 && HistoryMem.currentPosition < MAX_HISTORY-1 ){ 
-          // current history means the oldest possible will be MAX_HISTORY-1
-          earaseCurrentLineOnScreen(); // eraseing the whole line 
-          earaseContentOnInputBuf();   // erasing in input.buf
-          if (HistoryMem.currentPosition == -1) // if it is the first toggle we make then the our written command  should be stored.
-              copybuffToBeShiftedToOldBuf();
-          HistoryMem.currentPosition++; // toggling by increasing out current position.
-          tempIndex = (HistoryMem.FinalCMdIndex + HistoryMem.currentPosition) %MAX_HISTORY; // gives us the index of currentposition'th index from the recent command.
-          copyBufferToScreen(HistoryMem.CommandMemArr[ tempIndex]  , HistoryMem.lengthsArr[tempIndex]);
-          copyBufferToInputBuf(HistoryMem.CommandMemArr[ tempIndex]  , HistoryMem.lengthsArr[tempIndex]);
-        }
-        break;
       case DOWN_ARROW:
-        switch(HistoryMem.currentPosition){
-          case -1:
-            //does nothing
-            break;
-          case 0: // prints the string from oldbuff
-            earaseCurrentLineOnScreen();
-            copyBufferToInputBuf(oldBuf, lengthOfOldBuf);
-            copyBufferToScreen(oldBuf, lengthOfOldBuf);
-            HistoryMem.currentPosition--; // decreasing out current position.
-            break;
-          default:
-            earaseCurrentLineOnScreen();
-            HistoryMem.currentPosition--; // decreasing out current position.
-            tempIndex = (HistoryMem.FinalCMdIndex + HistoryMem.currentPosition) % MAX_HISTORY;
-            copyBufferToScreen(HistoryMem.CommandMemArr[ tempIndex]  , HistoryMem.lengthsArr[tempIndex]);
-            copyBufferToInputBuf(HistoryMem.CommandMemArr[ tempIndex]  , HistoryMem.lengthsArr[tempIndex]);
-            break;
-        }
+        // History is the shell's business (see sh.c).
         break;
       case '\n':
       case '\r':
-	  input.e = input.rightmost;
+      case C('D'):
+        linecommit(c == '\r' ? '\n' : c);
+        break;
       default:
-	if(c != 0 && input.e-input.r < INPUT_BUF){
-	  c = (c == '\r') ? '\n' : c;
-	  if (input.rightmost > input.e) { // caret isn't at the end of the line
-	    copybuffToBeShifted();
-	    input.buf[input.e++ % INPUT_BUF] = c;
-	    input.rightmost++;
-	    consputc(c);
-	    shiftbufright();
-	  }
-	  else {
-	    input.buf[input.e++ % INPUT_BUF] = c;
-	    input.rightmost = input.e - input.rightmost == 1 ? input.e : input.rightmost;
-	    consputc(c);
-	  }
-	  if(c == '\n' || c == C('D') || input.rightmost == input.r + INPUT_BUF){
-	    saveCMDinHistoryMem(); // when enter is entered we saving that command to historyMem
-	    input.w = input.rightmost;
-	    wakeup(&input.r);
-	  }
-	}
-	break;
+        if(c != 0)
+          lineinsert(c);
+        break;
       }
   }
+  lineredraw();
+  consflush();
   release(&cons.lock);
   if(doprocdump) {
     procdump();  // now call procdump() wo. cons.lock held
   }
 }
 
-// this method eareases the current line from screen
-void
-earaseCurrentLineOnScreen(void){
-    uint numToEarase = input.rightmost - input.r;
-    while (input.e < input.rightmost) { // taking caret to the end of the line.
-          consputc(input.buf[input.e % INPUT_BUF]);
-          input.e++;
-        }
-    uint i;
-    for (i = 0; i < numToEarase; i++) {
-      consputc(BACKSPACE); // backspacing the whole line.
-    }
-}
-
-// this method copies the chars currently on display (and on Input.buf) to oldBuf and save its length on current_history_viewed.lengthOld
-void
-copybuffToBeShiftedToOldBuf(void){
-    lengthOfOldBuf = input.rightmost - input.r;
-    uint i;
-    for (i = 0; i < lengthOfOldBuf; i++) {
-        oldBuf[i] = input.buf[(input.r+i)%INPUT_BUF];
-    }
-
-}
-
-// this method earase all the content of the current command on the inputbuf
-void
-earaseContentOnInputBuf(){
-  input.rightmost = input.r;
-  input.e = input.r;
-}
-
-/*
-  this method will print the given buf on the screen
-*/
-void
-copyBufferToScreen(char * bufToPrintOnScreen, uint length){
-  uint i;
-  for (i = 0; i < length; i++) {
-    consputc(bufToPrintOnScreen[i]);
-  }
-}
-
-
-// this method will copy the given buf to Input.buf will set the input.e and input.rightmost assumes input.r=input.w=input.rightmost=input.e
-void
-copyBufferToInputBuf(char * bufToSaveInInput, uint length){
-  uint i;
-  for (i = 0; i < length; i++) {
-    input.buf[(input.r+i)%INPUT_BUF] = bufToSaveInInput[i];
-  }
-  input.e = input.r+length;
-  input.rightmost = input.e;
-}
-
-// This method saves the current command into the historyMem
-void
-saveCMDinHistoryMem(){
-  HistoryMem.TotalCMDsInMem++; // counting the total no.of commands executed till now.
-  uint l = input.rightmost-input.r -1;
-  HistoryMem.FinalCMdIndex = (HistoryMem.FinalCMdIndex - 1) % MAX_HISTORY; // this step stores the commands in a cyclic manner if the memory is full. 
-  HistoryMem.lengthsArr[HistoryMem.FinalCMdIndex] = l;
-  uint i;
-  for (i = 0; i < l; i++) { //do not want to save in memory the last char '/n'
-    HistoryMem.CommandMemArr[HistoryMem.FinalCMdIndex][i] =  input.buf[(input.r+i)%INPUT_BUF];
-  }
-  return;
-}
-
-/*
-  this is the function that gets called by the sys_history and writes the requested command history in the buffer
-*/
-int history(char *buffer, int historyId) {
-  // this function returns command which was executed at historID+1 position in the stored MAX_HISTORY commands.
-  if (historyId < 0 || historyId > MAX_HISTORY - 1)
-    return -2;
-  if (historyId >= HistoryMem.TotalCMDsInMem )
-    return -1;
-  memset(buffer, '\0', INPUT_BUF);
-  uint temp;
-  if(HistoryMem.TotalCMDsInMem > MAX_HISTORY){
-    temp = HistoryMem.FinalCMdIndex - 1;
-  }
-  else{
-    temp = MAX_HISTORY - 1;
-  }
-  temp = (temp - historyId) % MAX_HISTORY;
-  memmove(buffer, HistoryMem.CommandMemArr[temp], HistoryMem.lengthsArr[temp]);
-  return 0;
-}
-
 int
 consoleread(struct inode *ip, char *dst, int n)
 {
@@ -504,6 +508,9 @@ consoleread(struct inode *ip, char *dst, int n)
   target = n;
   acquire(&cons.lock);
   while(n > 0){
+    // In raw mode, return whatever keys have come in.
+    if(cons.raw && n < target && input.r == input.w)
+      break;
     while(input.r == input.w){
       if(myproc()->killed){
         release(&cons.lock);
@@ -512,8 +519,8 @@ consoleread(struct inode *ip, char *dst, int n)
       }
       sleep(&input.r, &cons.lock);
     }
-    c = input.buf[input.r++ % INPUT_BUF];
-    if(c == C('D')){  // EOF
+    c = input.buf[input.r++ % LINE_BUF];
+    if(c == C('D') && !cons.raw){  // EOF
       if(n < target){
         // Save ^D for next time, to make sure
         // caller gets a 0-byte result.
@@ -541,12 +548,27 @@ consolewrite(struct inode *ip, char *buf, int n)
   acquire(&cons.lock);
   for(i = 0; i < n; i++)
     consputc(buf[i] & 0xff);
+  consflush();
   release(&cons.lock);
   ilock(ip);
 
   return n;
 }
 
+// Carry out ioctl() request req, with argument arg, on the console.
+int
+consoleioctl(int req, int arg)
+{
+  switch(req){
+  case CONS_RAW:
+    acquire(&cons.lock);
+    cons.raw = arg != 0;
+    release(&cons.lock);
+    return 0;
+  }
+  return -1;
+}
+
 void
 consoleinit(void)
 {
@@ -557,8 +579,7 @@ consoleinit(void)
   cons.locking = 1;
 
   ioapicenable(IRQ_KBD, 0);
-  HistoryMem.TotalCMDsInMem = 0;
-  HistoryMem.FinalCMdIndex = 0;
-  HistoryMem.currentPosition = -1;
+  line.ge = LINE_BUF;     // empty line: the gap is the whole buffer
+  line.dirty = LINE_BUF;
 }
 
@@ -21,7 +21,7 @@ void            consoleinit(void);
 void            cprintf(char*, ...);
 void            consoleintr(int(*)(void));
 void            panic(char*) __attribute__((noreturn));
-int             history(char* , int);
+int             consoleioctl(int, int);
 
 // exec.c
 int             exec(char*, char**);
@@ -170,6 +170,8 @@ extern struct spinlock tickslock;
 void            uartinit(void);
 void            uartintr(void);
 void            uartputc(int);
+void            uartwrite(char*, int);
+void            uartflush(void);
 
 // vm.c
 void            seginit(void);
@@ -0,0 +1,6 @@
+// Requests for the ioctl() system call.
+
+// Console: with arg 1, deliver each key to read() as it is typed,
+// without echo or line editing ('\r' still reads as '\n', and ^D
+// is an ordinary key); with arg 0, go back to editing lines.
+#define CONS_RAW  1
@@ -3,6 +3,9 @@
 #include "types.h"
 #include "user.h"
 #include "fcntl.h"
+#include "stat.h"
+#include "fs.h"
+#include "ioctl.h"
 
 // Parsed command representation
 #define EXEC  1
@@ -130,34 +133,594 @@ runcmd(struct cmd *cmd)
   exit();
 }
 
+//PAGEBREAK!
+// Line editing, completion and history.
+//
+// On the console, getcmd() puts it in raw mode (see ioctl.h) and
+// edits the line itself. History is one text of '\n'-terminated
+// lines, with an index of where each starts, and is appended to
+// HISTFILE as commands are entered; at startup the whole file is
+// read back with a single read(). The file is held open, at its
+// end, to append to; shells running at the same time each append
+// from where they loaded it.
+
+#define HISTFILE "/.history"
+#define LINEMAX 512
+
+#define C(x)  ((x)-'@')  // Control-x
+#define ESC 0x1b
+
+// Arrow keys from the keyboard (see kbd.h). The serial line sends
+// ESC [ A and so on instead, which readkey() turns into these.
+#define KEY_UP 0xE2
+#define KEY_DN 0xE3
+#define KEY_LF 0xE4
+#define KEY_RT 0xE5
+
+struct {
+  char *text;   // the lines, each ending in '\n'
+  uint len;     // bytes used in text
+  uint cap;     // bytes allocated for text
+  uint *idx;    // idx[i] is where line i starts in text
+  int n;        // number of lines
+  int ncap;     // entries allocated for idx
+  int fd;       // HISTFILE, open for appending, or -1
+} hist;
+
+// Make room in hist for n more bytes and one more line.
+void
+histroom(uint n)
+{
+  char *t;
+  uint *x;
+  uint cap;
+
+  if(hist.len + n > hist.cap){
+    for(cap = hist.cap ? hist.cap : 1024; cap < hist.len + n; cap *= 2)
+      ;
+    t = malloc(cap);
+    memmove(t, hist.text, hist.len);
+    if(hist.text)
+      free(hist.text);
+    hist.text = t;
+    hist.cap = cap;
+  }
+  if(hist.n == hist.ncap){
+    cap = hist.ncap ? hist.ncap*2 : 64;
+    x = malloc(cap*sizeof(x[0]));
+    memmove(x, hist.idx, hist.n*sizeof(x[0]));
+    if(hist.idx)
+      free(hist.idx);
+    hist.idx = x;
+    hist.ncap = cap;
+  }
+}
+
+// Line i of the history, and its length without the '\n'.
+char*
+histline(int i, int *len)
+{
+  char *s, *e;
+
+  s = hist.text + hist.idx[i];
+  for(e = s; *e != '\n'; e++)
+    ;
+  *len = e - s;
+  return s;
+}
+
+// Read the history file into hist.
+void
+histload(void)
+{
+  struct stat st;
+  uint i, start;
+
+  hist.fd = open(HISTFILE, O_CREATE | O_RDWR);
+  if(hist.fd < 0 || fstat(hist.fd, &st) < 0 || st.size == 0)
+    return;
+  histroom(st.size);
+  if(read(hist.fd, hist.text, st.size) != st.size)
+    return;
+  hist.len = st.size;
+  if(hist.text[hist.len-1] != '\n')  // torn last line
+    hist.text[hist.len-1] = '\n';
+  for(start = i = 0; i < hist.len; i++){
+    if(hist.text[i] != '\n')
+      continue;
+    histroom(0);
+    hist.idx[hist.n++] = start;
+    start = i+1;
+  }
+}
+
+// Add the n-byte line s, which ends in '\n', to the history.
+void
+histadd(char *s, int n)
+{
+  histroom(n);
+  memmove(hist.text + hist.len, s, n);
+  hist.idx[hist.n++] = hist.len;
+  hist.len += n;
+  if(hist.fd >= 0)
+    write(hist.fd, s, n);
+}
+
+// The latest line at or before from that contains the qn bytes
+// at q, or -1.
 int
-getcmd(char *buf, int nbuf)
+histsearch(char *q, int qn, int from)
 {
-  printf(2, "$ ");
-  memset(buf, 0, nbuf);
-  gets(buf, nbuf);
-  if(buf[0] == 0) // EOF
+  char *s;
+  int i, j, len;
+
+  for(; from >= 0; from--){
+    s = histline(from, &len);
+    for(i = 0; i + qn <= len; i++){
+      for(j = 0; j < qn && s[i+j] == q[j]; j++)
+        ;
+      if(j == qn)
+        return from;
+    }
+  }
+  return -1;
+}
+
+void
+printHistory(void)
+{
+  char *s;
+  int i, len;
+
+  for(i = 0; i < hist.n; i++){
+    s = histline(i, &len);
+    printf(1, "%d: ", i+1);
+    write(1, s, len+1);
+  }
+}
+
+// Output to the console, sent with one write() per redraw.
+struct {
+  char buf[256];
+  int n;
+} out;
+
+void
+outflush(void)
+{
+  write(2, out.buf, out.n);
+  out.n = 0;
+}
+
+void
+outc(int c)
+{
+  if(out.n == sizeof(out.buf))
+    outflush();
+  out.buf[out.n++] = c;
+}
+
+// What the line being edited looks like on the screen.
+struct {
+  char shown[LINEMAX+64];
+  int n;    // characters shown
+  int cur;  // where the caret is among them
+} ed;
+
+// Move the caret from position from to to with an ANSI escape.
+void
+edmove(int from, int to)
+{
+  char num[10];
+  int n, i;
+
+  if(from == to)
+    return;
+  n = from > to ? from - to : to - from;
+  for(i = 0; n > 0; n /= 10)
+    num[i++] = '0' + n % 10;
+  outc(ESC);
+  outc('[');
+  while(--i >= 0)
+    outc(num[i]);
+  outc(from > to ? 'D' : 'C');
+}
+
+// Make the screen show the n characters at s with the caret at
+// caret, rewriting only from the first character that differs.
+void
+edshow(char *s, int n, int caret)
+{
+  int i, d;
+
+  if(n > sizeof(ed.shown))
+    n = sizeof(ed.shown);
+  for(d = 0; d < n && d < ed.n && s[d] == ed.shown[d]; d++)
+    ;
+  if(d < n || d < ed.n){
+    edmove(ed.cur, d);
+    for(i = d; i < n; i++)
+      outc(s[i]);
+    for(; i < ed.n; i++)  // blank out what is gone
+      outc(' ');
+    ed.cur = i;
+  }
+  edmove(ed.cur, caret);
+  ed.cur = caret;
+  memmove(ed.shown, s, n);
+  ed.n = n;
+  outflush();
+}
+
+// Next key from the console, or -1 at end of input. Arrow keys
+// come as ESC [ or ESC O and a letter; any other escape is 0.
+int
+readkey(void)
+{
+  uchar c;
+
+  if(read(0, &c, 1) != 1)
+    return -1;
+  if(c != ESC)
+    return c;
+  if(read(0, &c, 1) != 1)
     return -1;
+  if(c != '[' && c != 'O')
+    return 0;
+  if(read(0, &c, 1) != 1)
+    return -1;
+  switch(c){
+  case 'A': return KEY_UP;
+  case 'B': return KEY_DN;
+  case 'C': return KEY_RT;
+  case 'D': return KEY_LF;
+  }
   return 0;
 }
-char getHistoryCommand[INPUT_BUF];
 
-void printHistory(){
-  uint i ;
-  uint count = 0;
-  for(i= 0; i <MAX_HISTORY; i++){
-    if(history(getHistoryCommand, i) == 0){
-      count++;
-      printf(1, "%d: %s\n", count, getHistoryCommand);
+// Directory listings for tab completion. Each is read with one
+// read() and kept, with entry types looked up only as needed,
+// until the next command runs and perhaps changes the directories.
+#define NLISTING 8
+
+struct listing {
+  char path[64];
+  int n;                    // entries
+  char (*name)[DIRSIZ+1];
+  short *type;              // 0 until looked up
+} listing[NLISTING];
+int nlisting;
+
+void
+listdrop(void)
+{
+  int i;
+
+  for(i = 0; i < nlisting; i++){
+    free(listing[i].name);
+    free(listing[i].type);
+  }
+  nlisting = 0;
+}
+
+// The listing of directory path, or 0.
+struct listing*
+listdir(char *path)
+{
+  struct listing *l;
+  struct dirent *de;
+  struct stat st;
+  char *buf;
+  int fd, i, n;
+
+  for(i = 0; i < nlisting; i++)
+    if(strcmp(listing[i].path, path) == 0)
+      return &listing[i];
+  if(nlisting == NLISTING)
+    listdrop();
+  if(strlen(path) >= sizeof(l->path) || (fd = open(path, O_RDONLY)) < 0)
+    return 0;
+  if(fstat(fd, &st) < 0 || st.type != T_DIR){
+    close(fd);
+    return 0;
+  }
+  buf = malloc(st.size + 1);
+  if((n = read(fd, buf, st.size)) < 0)
+    n = 0;
+  n /= sizeof(*de);
+  close(fd);
+
+  l = &listing[nlisting++];
+  strcpy(l->path, path);
+  l->name = malloc((n+1) * sizeof(l->name[0]));
+  l->type = malloc((n+1) * sizeof(l->type[0]));
+  l->n = 0;
+  for(de = (struct dirent*)buf; de < (struct dirent*)buf + n; de++){
+    if(de->inum == 0)
+      continue;
+    memmove(l->name[l->n], de->name, DIRSIZ);
+    l->name[l->n][DIRSIZ] = 0;
+    l->type[l->n++] = 0;
+  }
+  free(buf);
+  return l;
+}
+
+// Type of entry i of listing l.
+int
+listtype(struct listing *l, int i)
+{
+  char path[sizeof(l->path) + DIRSIZ + 1];
+  struct stat st;
+  int n;
+
+  if(l->type[i] == 0){
+    strcpy(path, l->path);
+    n = strlen(path);
+    path[n++] = '/';
+    strcpy(path + n, l->name[i]);
+    l->type[i] = stat(path, &st) < 0 ? -1 : st.type;
+  }
+  return l->type[i];
+}
+
+// Whether entry i of l completes the wn characters at base:
+// hidden names only if asked for, and no directories as commands.
+int
+listmatch(struct listing *l, int i, char *base, int wn, int first)
+{
+  int j;
+
+  for(j = 0; j < wn && l->name[i][j] == base[j]; j++)
+    ;
+  if(j < wn || (wn == 0 && l->name[i][0] == '.'))
+    return 0;
+  return !first || listtype(l, i) != T_DIR;
+}
+
+// Insert the k characters at s into buf at the caret.
+void
+edinsert(char *buf, int nbuf, int *n, int *pos, char *s, int k)
+{
+  if(k > nbuf-2 - *n)
+    k = nbuf-2 - *n;
+  memmove(buf + *pos + k, buf + *pos, *n - *pos);
+  memmove(buf + *pos, s, k);
+  *n += k;
+  *pos += k;
+}
+
+// Complete the word before the caret: as a path if it is an
+// argument, or, as the command of a pipeline element, as the name
+// of a file (an executable) rather than a directory. With several
+// choices, add what they have in common, or, if nothing, list them
+// and return 1: the line must then be redrawn.
+int
+complete(char *buf, int nbuf, int *n, int *pos)
+{
+  struct listing *l;
+  char dir[64], *w, *base;
+  int i, j, wn, bn, first, last, common, nmatch;
+
+  for(i = *pos; i > 0 && !strchr(" \t|;&<>", buf[i-1]); i--)
+    ;
+  w = buf + i;
+  wn = *pos - i;
+  for(j = i; j > 0 && strchr(" \t", buf[j-1]); j--)
+    ;
+  first = j == 0 || strchr("|;&", buf[j-1]);
+
+  // The word is dir/base.
+  for(bn = wn; bn > 0 && w[bn-1] != '/'; bn--)
+    ;
+  if(bn >= sizeof(dir))
+    return 0;
+  if(bn == 0)
+    strcpy(dir, ".");
+  else {
+    memmove(dir, w, bn);
+    dir[bn] = 0;
+  }
+  base = w + bn;
+  wn -= bn;
+  if((l = listdir(dir)) == 0)
+    return 0;
+
+  nmatch = 0;
+  last = common = 0;
+  for(i = 0; i < l->n; i++){
+    if(!listmatch(l, i, base, wn, first))
+      continue;
+    if(nmatch++ == 0)
+      common = strlen(l->name[i]);
+    else {
+      for(j = wn; j < common && l->name[i][j] == l->name[last][j]; j++)
+        ;
+      common = j;
+    }
+    last = i;
+  }
+  if(nmatch == 0)
+    return 0;
+
+  edinsert(buf, nbuf, n, pos, l->name[last] + wn, common - wn);
+  if(nmatch == 1)
+    edinsert(buf, nbuf, n, pos, listtype(l, last) == T_DIR ? "/" : " ", 1);
+  if(nmatch == 1 || common > wn)
+    return 0;
+
+  // List the choices under the line.
+  edshow(buf, *n, *n);
+  printf(2, "\n");
+  for(i = 0; i < l->n; i++)
+    if(listmatch(l, i, base, wn, first))
+      printf(2, "%s  ", l->name[i]);
+  printf(2, "\n");
+  return 1;
+}
+
+// Set the line in buf, of room nbuf, to the n characters at s.
+// Returns the new length.
+int
+edset(char *buf, int nbuf, char *s, int n)
+{
+  if(n > nbuf-2)
+    n = nbuf-2;
+  memmove(buf, s, n);
+  return n;
+}
+
+// Read a line into buf, of room nbuf, from the console in raw mode.
+// Tab completes the word before the caret (see complete()).
+// Up and down step through the history; Ctrl-R searches it
+// backwards for what is typed next, Ctrl-R again for an older
+// match, and any key but those and backspace takes the match.
+// Returns the length, with the '\n', or -1 at end of input.
+int
+editline(char *buf, int nbuf)
+{
+  static char saved[LINEMAX], disp[LINEMAX+64];
+  char q[32], *s;
+  int c, n, pos, h, nsaved, qn, match, len;
+
+  n = pos = nsaved = qn = 0;
+  h = hist.n;   // history line shown; hist.n is the new line
+  match = -2;   // not searching
+  ed.n = ed.cur = 0;
+  for(;;){
+    if((c = readkey()) < 0)
+      return -1;
+
+    if(match != -2){
+      if(c == C('R') || c == C('H') || c == '\x7f' || (c >= ' ' && c < 0x7f)){
+        if(c == C('R'))
+          match = histsearch(q, qn, (match >= 0 ? match : hist.n) - 1);
+        else {
+          if(c == C('H') || c == '\x7f'){
+            if(qn > 0)
+              qn--;
+          } else if(qn < sizeof(q))
+            q[qn++] = c;
+          match = histsearch(q, qn, hist.n-1);
+        }
+        len = 0;
+        s = match >= 0 ? histline(match, &len) : "";
+        memmove(disp, "(search)`", 9);
+        memmove(disp+9, q, qn);
+        memmove(disp+9+qn, "': ", 3);
+        if(len > LINEMAX)
+          len = LINEMAX;
+        memmove(disp+12+qn, s, len);
+        edshow(disp, 12+qn+len, 9+qn);
+        continue;
+      }
+      if(match >= 0){
+        s = histline(match, &len);
+        n = pos = edset(buf, nbuf, s, len);
+        h = match;
+      }
+      match = -2;
+      if(c == C('G'))  // just leave the search
+        c = 0;
     }
+
+    switch(c){
+    case '\n':
+      edshow(buf, n, n);
+      write(2, "\n", 1);
+      buf[n++] = '\n';
+      buf[n] = 0;
+      return n;
+    case C('D'):
+      if(n == 0)
+        return -1;
+      break;
+    case C('H'):
+    case '\x7f':
+      if(pos > 0){
+        memmove(buf+pos-1, buf+pos, n-pos);
+        pos--;
+        n--;
+      }
+      break;
+    case C('U'):
+      memmove(buf, buf+pos, n-pos);
+      n -= pos;
+      pos = 0;
+      break;
+    case KEY_LF:
+      if(pos > 0)
+        pos--;
+      break;
+    case KEY_RT:
+      if(pos < n)
+        pos++;
+      break;
+    case KEY_UP:
+    case KEY_DN:
+      if((c == KEY_UP && h == 0) || (c == KEY_DN && h == hist.n))
+        break;
+      if(h == hist.n)
+        nsaved = edset(saved, sizeof(saved), buf, n);
+      h += c == KEY_UP ? -1 : 1;
+      if(h == hist.n)
+        n = edset(buf, nbuf, saved, nsaved);
+      else {
+        s = histline(h, &len);
+        n = edset(buf, nbuf, s, len);
+      }
+      pos = n;
+      break;
+    case '\t':
+      if(complete(buf, nbuf, &n, &pos)){
+        write(2, "$ ", 2);
+        ed.n = ed.cur = 0;
+      }
+      break;
+    case C('R'):
+      qn = 0;
+      match = -1;
+      memmove(disp, "(search)`': ", 12);
+      edshow(disp, 12, 9);
+      continue;
+    default:
+      if(c >= ' ' && n < nbuf-2){
+        memmove(buf+pos+1, buf+pos, n-pos);
+        buf[pos++] = c;
+        n++;
+      }
+      break;
+    }
+    edshow(buf, n, pos);
   }
-  return;
+}
+
+int
+getcmd(char *buf, int nbuf)
+{
+  int n;
+
+  printf(2, "$ ");
+  memset(buf, 0, nbuf);
+  if(ioctl(0, CONS_RAW, 1) < 0){  // not the console
+    gets(buf, nbuf);
+    if(buf[0] == 0) // EOF
+      return -1;
+    return 0;
+  }
+  n = editline(buf, nbuf);
+  ioctl(0, CONS_RAW, 0);
+  if(n < 0) // EOF
+    return -1;
+  if(n > 1)
+    histadd(buf, n);
+  return 0;
 }
 
 int
 main(void)
 {
-  static char buf[100];
+  static char buf[LINEMAX];
   int fd;
 
   // Ensure that three file descriptors are open.
@@ -167,9 +730,11 @@ main(void)
       break;
     }
   }
+  histload();
 
   // Read and run input commands.
   while(getcmd(buf, sizeof(buf)) >= 0){
+    listdrop();
     if(buf[0] == 'c' && buf[1] == 'd' && buf[2] == ' '){
       // Chdir must be called by the parent, not the child.
       buf[strlen(buf)-1] = 0;  // chop \n
@@ -177,12 +742,15 @@ main(void)
         printf(2, "cannot cd %s\n", buf+3);
       continue;
     }
-    if(buf[0] == 'h' && buf[1] == 'i' && buf[2] == 's'  && buf[3] == 't' && buf[4] == 'o' && buf[5] == 'r' && buf[6] == 'y' && buf[7] == '\n'){
+    if(strcmp(buf, "history\n") == 0){
       printHistory();
       continue;
     }
-    if(fork1() == 0)
+    if(fork1() == 0){
+      if(hist.fd >= 0)
+        close(hist.fd);
       runcmd(parsecmd(buf));
+    }
     wait();
   }
   exit();
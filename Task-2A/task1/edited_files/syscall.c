@@ -104,7 +104,7 @@ extern int sys_wait(void);
 extern int sys_write(void);
 extern int sys_uptime(void);
 extern int sys_draw(void);
-extern int sys_history(void);
+extern int sys_ioctl(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -130,8 +130,7 @@ static int (*syscalls[])(void) = {
 [SYS_close]   sys_close,
 // adding system call vector
 [SYS_draw] sys_draw,
-// adding system call history
-[SYS_history] sys_history,
+[SYS_ioctl]   sys_ioctl,
 };
 
 void
@@ -22,4 +22,4 @@
 #define SYS_close  21
 // A macro for SYS_draw as 22 which is its system call number.
 #define SYS_draw 22
-#define SYS_history 23
+#define SYS_ioctl 23
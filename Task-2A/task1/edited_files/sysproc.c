@@ -6,6 +6,11 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "proc.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "file.h"
+#include "stat.h"
 #include "ASCII_image.h"
 int
 sys_fork(void)
@@ -138,13 +143,24 @@ int sys_draw(void)
   return drawsize;
 }
 
-int sys_history(void) {
-  char *buffer;
-  int historyId;
-  
-  argptr(0, &buffer, 1);
-  
-  argint(1, &historyId);
+// Device-specific request on an open device file.
+// Only the console has any (see ioctl.h).
+int
+sys_ioctl(void)
+{
+  struct file *f;
+  int fd, req, arg, isconsole;
 
-  return history(buffer, historyId);
+  if(argint(0, &fd) < 0 || argint(1, &req) < 0 || argint(2, &arg) < 0)
+    return -1;
+  if(fd < 0 || fd >= NOFILE || (f = myproc()->ofile[fd]) == 0)
+    return -1;
+  if(f->type != FD_INODE)
+    return -1;
+  ilock(f->ip);
+  isconsole = f->ip->type == T_DEV && f->ip->major == CONSOLE;
+  iunlock(f->ip);
+  if(!isconsole)
+    return -1;
+  return consoleioctl(req, arg);
 }
@@ -2,6 +2,3 @@ typedef unsigned int   uint;
 typedef unsigned short ushort;
 typedef unsigned char  uchar;
 typedef uint pde_t;
-
-#define INPUT_BUF 128
-#define MAX_HISTORY 16
\ No newline at end of file
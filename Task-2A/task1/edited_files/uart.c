@@ -0,0 +1,157 @@
+// Intel 8250 serial port (UART).
+//
+// Output goes through a ring that the transmitter-empty interrupt
+// drains, so writers do not wait for the line. The interrupt is
+// enabled only while the ring has something in it.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "traps.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "file.h"
+#include "mmu.h"
+#include "proc.h"
+#include "x86.h"
+
+#define COM1    0x3f8
+
+#define UARTTXSIZE 1024
+
+static int uart;    // is there a uart?
+
+static struct {
+  struct spinlock lock;
+  char buf[UARTTXSIZE];
+  uint r;     // next byte to send
+  uint w;     // next free slot
+  int fifo;   // bytes the transmitter takes at a time
+  int ier;    // interrupts enabled
+} tx;
+
+void
+uartinit(void)
+{
+  char *p;
+
+  // Turn on the FIFOs, with an interrupt for each received byte.
+  outb(COM1+2, 0x07);
+
+  // 9600 baud, 8 data bits, 1 stop bit, parity off.
+  outb(COM1+3, 0x80);    // Unlock divisor
+  outb(COM1+0, 115200/9600);
+  outb(COM1+1, 0);
+  outb(COM1+3, 0x03);    // Lock divisor, 8 data bits.
+  outb(COM1+4, 0);
+  outb(COM1+1, 0x01);    // Enable receive interrupts.
+
+  // If status is 0xFF, no serial port.
+  if(inb(COM1+5) == 0xFF)
+    return;
+  uart = 1;
+  initlock(&tx.lock, "uart");
+  tx.ier = 0x01;
+
+  // Acknowledge pre-existing interrupt conditions;
+  // enable interrupts. A 16550 reports its FIFOs as on;
+  // an 8250 has none.
+  tx.fifo = (inb(COM1+2) & 0xC0) == 0xC0 ? 16 : 1;
+  inb(COM1+0);
+  ioapicenable(IRQ_COM1, 0);
+
+  // Announce that we're here.
+  for(p="xv6...\n"; *p; p++)
+    uartputc(*p);
+}
+
+// Give the transmitter what it can take from the ring, and have
+// it interrupt when it is empty if there is more. Caller holds
+// tx.lock.
+static void
+uartstart(void)
+{
+  int i, ier;
+
+  if(tx.r != tx.w && (inb(COM1+5) & 0x20))
+    for(i = 0; i < tx.fifo && tx.r != tx.w; i++)
+      outb(COM1+0, tx.buf[tx.r++ % UARTTXSIZE]);
+
+  ier = tx.r != tx.w ? 0x03 : 0x01;
+  if(ier != tx.ier){
+    outb(COM1+1, ier);
+    tx.ier = ier;
+  }
+}
+
+// Send the oldest byte in the ring by polling the transmitter,
+// as stock xv6 sent every byte. For when the ring is full, or
+// interrupts may never come.
+static void
+uartpoll(void)
+{
+  int i;
+
+  for(i = 0; i < 128 && !(inb(COM1+5) & 0x20); i++)
+    microdelay(10);
+  outb(COM1+0, tx.buf[tx.r++ % UARTTXSIZE]);
+}
+
+// Queue n bytes for sending. Only waits if the ring is full.
+void
+uartwrite(char *s, int n)
+{
+  int i;
+
+  if(!uart || n <= 0)
+    return;
+  acquire(&tx.lock);
+  for(i = 0; i < n; i++){
+    if(tx.w - tx.r == UARTTXSIZE)
+      uartpoll();
+    tx.buf[tx.w++ % UARTTXSIZE] = s[i];
+  }
+  uartstart();
+  release(&tx.lock);
+}
+
+void
+uartputc(int c)
+{
+  char ch;
+
+  ch = c;
+  uartwrite(&ch, 1);
+}
+
+// Send everything queued, without interrupts. For panic().
+void
+uartflush(void)
+{
+  if(!uart)
+    return;
+  while(tx.r != tx.w)
+    uartpoll();
+}
+
+static int
+uartgetc(void)
+{
+  if(!uart)
+    return -1;
+  if(!(inb(COM1+5) & 0x01))
+    return -1;
+  return inb(COM1+0);
+}
+
+void
+uartintr(void)
+{
+  consoleintr(uartgetc);
+  if(!uart)
+    return;
+  acquire(&tx.lock);
+  uartstart();
+  release(&tx.lock);
+}
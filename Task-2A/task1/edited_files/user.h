@@ -25,8 +25,7 @@ int sleep(int);
 int uptime(void);
 // system call created which copies the ASCII image of wolf picture
 int draw(void *buf, uint size);
-// system call which print last 16 commands executed.
-int history(char *buf, uint historyId);
+int ioctl(int, int, int);
 
 // ulib.c
 int stat(const char*, struct stat*);
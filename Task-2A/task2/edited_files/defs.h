@@ -9,6 +9,7 @@ struct spinlock;
 struct sleeplock;
 struct stat;
 struct superblock;
+struct trapframe;
 
 // bio.c
 void            binit(void);
@@ -22,6 +23,7 @@ void            cprintf(char*, ...);
 void            consoleintr(int(*)(void));
 void            panic(char*) __attribute__((noreturn));
 int             history(char* , int);
+int             consoleioctl(int, int);
 
 // exec.c
 int             exec(char*, char**);
@@ -120,6 +122,15 @@ void            sleep(void*, struct spinlock*);
 void            userinit(void);
 int             wait(void);
 int             wait2(int *, int *, int *); // adding wait2 here.
+int             vfork(void);
+void            vforkdone(struct proc*);
+int             waitpid(int, int*, int);
+int             setpgid(int, int);
+int             sigsend(int, int);
+void            stopcheck(void);
+void            sigcheck(struct trapframe*);
+int             signal(int, uint);
+int             sigreturn(void);
 void            wakeup(void*);
 void            yield(void);
 
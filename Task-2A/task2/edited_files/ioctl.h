@@ -0,0 +1,5 @@
+// Requests for the ioctl() system call.
+
+// Console: make process group arg the foreground job, which gets
+// SIGINT on ^C and SIGTSTP on ^Z (see signal.h); 0 for none.
+#define CONS_FGPGRP  1
@@ -6,6 +6,9 @@
 #include "x86.h"
 #include "proc.h"
 #include "spinlock.h"
+#include "signal.h"
+#include "syscall.h"
+#include "traps.h"
 
 struct {
   struct spinlock lock;
@@ -19,6 +22,8 @@ extern void forkret(void);
 extern void trapret(void);
 
 static void wakeup1(void *chan);
+static void stop1(void);
+static void signal1(struct proc*, int);
 
 void
 pinit(void)
@@ -88,6 +93,12 @@ allocproc(void)
 found:
   p->state = EMBRYO;
   p->pid = nextpid++;
+  p->pgid = 0;
+  p->sigpend = 0;
+  p->stopped = 0;
+  p->stopreport = 0;
+  p->sigmask = 0;
+  memset(p->sighand, 0, sizeof(p->sighand));
 
   release(&ptable.lock);
 
@@ -141,6 +152,7 @@ userinit(void)
 
   safestrcpy(p->name, "initcode", sizeof(p->name));
   p->cwd = namei("/");
+  p->pgid = p->pid;
 
   // this assignment to p->state lets other cores
   // run this process. the acquire forces the above
@@ -161,6 +173,8 @@ growproc(int n)
   uint sz;
   struct proc *curproc = myproc();
 
+  if(curproc->vfork)  // the memory is the parent's
+    return -1;
   sz = curproc->sz;
   if(n > 0){
     if((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
@@ -198,6 +212,9 @@ fork(void)
   }
   np->sz = curproc->sz;
   np->parent = curproc;
+  np->pgid = curproc->pgid;
+  np->sigmask = curproc->sigmask;
+  memmove(np->sighand, curproc->sighand, sizeof(np->sighand));
   *np->tf = *curproc->tf;
 
   // Clear %eax so that fork returns 0 in the child.
@@ -221,6 +238,66 @@ fork(void)
   return pid;
 }
 
+// Like fork, but the child runs in the parent's memory instead of
+// a copy, and the parent waits until the child execs or exits and
+// so gives the memory back. Meanwhile the child must not return
+// from the function that called vfork() or change memory that the
+// parent will use, and cannot grow its memory.
+int
+vfork(void)
+{
+  int i, pid;
+  struct proc *np;
+  struct proc *curproc = myproc();
+
+  // Allocate process.
+  if((np = allocproc()) == 0){
+    return -1;
+  }
+
+  np->pgdir = curproc->pgdir;
+  np->vfork = 1;
+  np->sz = curproc->sz;
+  np->parent = curproc;
+  np->pgid = curproc->pgid;
+  np->sigmask = curproc->sigmask;
+  memmove(np->sighand, curproc->sighand, sizeof(np->sighand));
+  *np->tf = *curproc->tf;
+
+  // Clear %eax so that vfork returns 0 in the child.
+  np->tf->eax = 0;
+
+  for(i = 0; i < NOFILE; i++)
+    if(curproc->ofile[i])
+      np->ofile[i] = filedup(curproc->ofile[i]);
+  np->cwd = idup(curproc->cwd);
+
+  safestrcpy(np->name, curproc->name, sizeof(curproc->name));
+
+  pid = np->pid;
+
+  acquire(&ptable.lock);
+
+  np->state = RUNNABLE;
+
+  while(np->vfork)
+    sleep(np, &ptable.lock);
+
+  release(&ptable.lock);
+
+  return pid;
+}
+
+// The vfork child p has its own memory now: let the parent go on.
+void
+vforkdone(struct proc *p)
+{
+  acquire(&ptable.lock);
+  p->vfork = 0;
+  wakeup1(p);
+  release(&ptable.lock);
+}
+
 // Exit the current process.  Does not return.
 // An exited process remains in the zombie state
 // until its parent calls wait() to find out it exited.
@@ -249,8 +326,16 @@ exit(void)
 
   acquire(&ptable.lock);
 
-  // Parent might be sleeping in wait().
+  // A vfork child gives its parent's memory back.
+  if(curproc->vfork){
+    curproc->vfork = 0;
+    curproc->pgdir = 0;
+    wakeup1(curproc);
+  }
+
+  // Parent might be sleeping in wait(), or want to know.
   wakeup1(curproc->parent);
+  signal1(curproc->parent, SIGCHLD);
 
   // Pass abandoned children to init.
   for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
@@ -267,6 +352,25 @@ exit(void)
   panic("zombie exit");
 }
 
+// Free zombie p, for a wait. Caller must hold ptable.lock.
+static void
+reap(struct proc *p)
+{
+  kfree(p->kstack);
+  p->kstack = 0;
+  if(p->pgdir)  // not a vfork child that never exec'ed
+    freevm(p->pgdir);
+  p->state = UNUSED;
+  p->pid = 0;
+  p->parent = 0;
+  p->name[0] = 0;
+  p->killed = 0;
+  p->ctime = 0;
+  p->retime = 0;
+  p->rutime = 0;
+  p->stime = 0;
+}
+
 // Wait for a child process to exit and return its pid.
 // Return -1 if this process has no children.
 int
@@ -278,6 +382,7 @@ wait(void)
   
   acquire(&ptable.lock);
   for(;;){
+    stop1();  // a job can be stopped while it waits
     // Scan through table looking for exited children.
     havekids = 0;
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
@@ -287,14 +392,7 @@ wait(void)
       if(p->state == ZOMBIE){
         // Found one.
         pid = p->pid;
-        kfree(p->kstack);
-        p->kstack = 0;
-        freevm(p->pgdir);
-        p->pid = 0;
-        p->parent = 0;
-        p->name[0] = 0;
-        p->killed = 0;
-        p->state = UNUSED;
+        reap(p);
         release(&ptable.lock);
         return pid;
       }
@@ -318,6 +416,7 @@ int wait2(int *retime, int *rutime, int *stime) {
   int havekids, pid;
   acquire(&ptable.lock);
   for(;;){
+    stop1();  // a job can be stopped while it waits
     // Scan through table looking for zombie children.
     havekids = 0;
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
@@ -331,18 +430,7 @@ int wait2(int *retime, int *rutime, int *stime) {
         *rutime = p->rutime;
         *stime = p->stime;
         pid = p->pid;
-        kfree(p->kstack);
-        p->kstack = 0;
-        freevm(p->pgdir);
-        p->state = UNUSED;
-        p->pid = 0;
-        p->parent = 0;
-        p->name[0] = 0;
-        p->killed = 0;
-        p->ctime = 0;
-        p->retime = 0;
-        p->rutime = 0;
-        p->stime = 0;
+        reap(p);
         release(&ptable.lock);
         return pid;
       }
@@ -358,6 +446,55 @@ int wait2(int *retime, int *rutime, int *stime) {
   }
 }
 
+// Wait for child pid, or any child if pid is -1, to exit and return
+// its pid, setting *status to WEXITED. With WUNTRACED, also return
+// once a child stops, setting *status to WSTOPPED; with WNOHANG,
+// return 0 instead of waiting. Return -1 if there is no such child.
+int
+waitpid(int pid, int *status, int options)
+{
+  struct proc *p;
+  int havekids;
+  struct proc *curproc = myproc();
+
+  acquire(&ptable.lock);
+  for(;;){
+    stop1();
+    havekids = 0;
+    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+      if(p->parent != curproc || (pid != -1 && p->pid != pid))
+        continue;
+      havekids = 1;
+      if(p->state == ZOMBIE){
+        *status = WEXITED;
+        pid = p->pid;
+        reap(p);
+        release(&ptable.lock);
+        return pid;
+      }
+      if(p->stopreport && (options & WUNTRACED)){
+        p->stopreport = 0;
+        *status = WSTOPPED;
+        release(&ptable.lock);
+        return p->pid;
+      }
+    }
+
+    if(!havekids || curproc->killed){
+      release(&ptable.lock);
+      return -1;
+    }
+    if(options & WNOHANG){
+      release(&ptable.lock);
+      return 0;
+    }
+
+    // Wait for children to exit or stop.  (See wakeup1 calls in
+    // exit and stop1.)
+    sleep(curproc, &ptable.lock);
+  }
+}
+
 //PAGEBREAK: 42
 // Per-CPU process scheduler.
 // Each CPU calls scheduler() after setting itself up.
@@ -543,6 +680,237 @@ kill(int pid)
   return -1;
 }
 
+// Put the caller, or its child pid, in process group pgid.
+// A pid or pgid of 0 stands for the pid of the caller or child,
+// so setpgid(0, 0) starts a group led by the caller.
+int
+setpgid(int pid, int pgid)
+{
+  struct proc *p;
+  struct proc *curproc = myproc();
+
+  if(pid == 0)
+    pid = curproc->pid;
+  if(pgid == 0)
+    pgid = pid;
+  acquire(&ptable.lock);
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->pid == pid && (p == curproc || p->parent == curproc)){
+      p->pgid = pgid;
+      release(&ptable.lock);
+      return 0;
+    }
+  }
+  release(&ptable.lock);
+  return -1;
+}
+
+//PAGEBREAK!
+// Signals (see signal.h). sigsend() carries out default actions
+// that kill or stop at once; caught signals are left pending in
+// p->sigpend, and sigcheck() runs their handlers on the way back
+// to user space.
+
+// Give signal sig to p. Like kill, wake p from sleep if it has
+// something to notice: it is to die, stop or go on, or it has a
+// handler to run and does not block sig. An ignored signal leaves
+// it asleep. Caller must hold ptable.lock.
+static void
+signal1(struct proc *p, int sig)
+{
+  uint h;
+  int wake;
+
+  wake = 0;
+  if(sig == SIGCONT){  // whatever the handler
+    wake = p->stopped;
+    p->stopped = 0;
+    p->stopreport = 0;
+  }
+  h = p->sighand[sig];
+  if(sig == SIGKILL || h == (uint)SIG_DFL){
+    if(sig == SIGTSTP){
+      p->stopped = 1;
+      wake = 1;
+    } else if(sig != SIGCONT && sig != SIGCHLD){
+      p->killed = 1;
+      p->stopreport = 0;
+      wake = 1;
+    }
+  } else if(h != (uint)SIG_IGN){
+    p->sigpend |= SIGBIT(sig);
+    if(!(p->sigmask & SIGBIT(sig)))
+      wake = 1;
+  }
+  if(wake && p->state == SLEEPING)
+    p->state = RUNNABLE;
+}
+
+// Send signal sig to process pid or, if pid is negative, to every
+// process in group -pid. Return -1 if there is no such process.
+int
+sigsend(int pid, int sig)
+{
+  struct proc *p;
+  int found;
+
+  if(sig <= 0 || sig >= NSIG)
+    return -1;
+  found = 0;
+  acquire(&ptable.lock);
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(p->state == UNUSED || p->state == ZOMBIE)
+      continue;
+    if(pid > 0 ? p->pid == pid : p->pgid == -pid){
+      signal1(p, sig);
+      found = 1;
+    }
+  }
+  release(&ptable.lock);
+  return found ? 0 : -1;
+}
+
+// If SIGTSTP has asked the current process to stop, stop until
+// SIGCONT (or a kill), letting the parent's waitpid know. Processes
+// stop on their way back to user space (see sigcheck) and in waits
+// that allow it. Caller must hold ptable.lock.
+static void
+stop1(void)
+{
+  struct proc *p = myproc();
+
+  if(!p->stopped)
+    return;
+  p->stopreport = 1;
+  wakeup1(p->parent);
+  while(p->stopped && !p->killed)
+    sleep(&p->stopped, &ptable.lock);
+  p->stopped = 0;
+}
+
+// stop1 for callers without ptable.lock.
+void
+stopcheck(void)
+{
+  acquire(&ptable.lock);
+  stop1();
+  release(&ptable.lock);
+}
+
+// Set the handler for signal sig to h: a user address, SIG_DFL or
+// SIG_IGN. SIGKILL cannot be caught or ignored.
+int
+signal(int sig, uint h)
+{
+  struct proc *curproc = myproc();
+
+  if(sig <= 0 || sig >= NSIG || sig == SIGKILL)
+    return -1;
+  acquire(&ptable.lock);
+  curproc->sighand[sig] = h;
+  if(h == (uint)SIG_IGN)
+    curproc->sigpend &= ~SIGBIT(sig);
+  release(&ptable.lock);
+  return 0;
+}
+
+// What sigcheck() pushes on the user stack to call a handler. The
+// handler returns into code[], which calls sigreturn().
+struct sigframe {
+  uint ret;              // the handler's return address: code
+  int sig;               // the handler's argument
+  uint mask;             // p->sigmask to go back to
+  struct trapframe tf;   // user registers to go back to
+  uchar code[8];
+};
+
+// On the way back to user space with registers tf, stop if asked
+// to, and then set up a call to the handler of a pending signal,
+// if any. The signal is blocked until the handler returns.
+void
+sigcheck(struct trapframe *tf)
+{
+  struct proc *p = myproc();
+  struct sigframe f;
+  uint sp, h;
+  int sig;
+
+  acquire(&ptable.lock);
+  stop1();
+  for(sig = 1; sig < NSIG; sig++)
+    if(p->sigpend & ~p->sigmask & SIGBIT(sig))
+      break;
+  if(sig == NSIG || p->killed){
+    release(&ptable.lock);
+    return;
+  }
+  p->sigpend &= ~SIGBIT(sig);
+  h = p->sighand[sig];
+  if(h == (uint)SIG_DFL || h == (uint)SIG_IGN){
+    // Default action, the handler having been reset since.
+    if(h == (uint)SIG_DFL && sig != SIGCHLD && sig != SIGCONT){
+      if(sig == SIGTSTP){
+        p->stopped = 1;
+        stop1();
+      } else
+        p->killed = 1;
+    }
+    release(&ptable.lock);
+    return;
+  }
+  f.mask = p->sigmask;
+  p->sigmask |= SIGBIT(sig);
+  release(&ptable.lock);
+
+  sp = (tf->esp - sizeof(f)) & ~3;
+  f.ret = sp + (uint)&((struct sigframe*)0)->code;
+  f.sig = sig;
+  f.tf = *tf;
+  f.code[0] = 0xb8;  // movl $SYS_sigreturn, %eax
+  *(uint*)&f.code[1] = SYS_sigreturn;
+  f.code[5] = 0xcd;  // int $T_SYSCALL
+  f.code[6] = T_SYSCALL;
+  f.code[7] = 0x90;  // nop
+  if(copyout(p->pgdir, sp, &f, sizeof(f)) < 0){
+    p->killed = 1;  // no room on the stack
+    return;
+  }
+  tf->esp = sp;
+  tf->eip = h;
+}
+
+// Return from a handler to where the process was when sigcheck()
+// called it, and unblock the signal. Returns the saved %eax, so
+// that the interrupted system call, if any, returns what it did.
+int
+sigreturn(void)
+{
+  struct proc *curproc = myproc();
+  struct trapframe *tf = curproc->tf;
+  struct sigframe *f;
+
+  // The handler's ret popped f->ret.
+  f = (struct sigframe*)(tf->esp - 4);
+  if(tf->esp < 4 || tf->esp - 4 >= curproc->sz ||
+     curproc->sz - (tf->esp - 4) < sizeof(*f))
+    return -1;
+  curproc->sigmask = f->mask;
+
+  // Only what user code could have set: not segments, and of
+  // eflags only the condition codes, DF and TF.
+  tf->edi = f->tf.edi;
+  tf->esi = f->tf.esi;
+  tf->ebp = f->tf.ebp;
+  tf->ebx = f->tf.ebx;
+  tf->edx = f->tf.edx;
+  tf->ecx = f->tf.ecx;
+  tf->eax = f->tf.eax;
+  tf->eip = f->tf.eip;
+  tf->esp = f->tf.esp;
+  tf->eflags = (tf->eflags & ~0xdd5) | (f->tf.eflags & 0xdd5);
+  return tf->eax;
+}
+
 //PAGEBREAK: 36
 // Print a process listing to console.  For debugging.
 // Runs when user types ^P on console.
@@ -53,6 +53,13 @@ struct proc {
   uint stime;                  // process sleeping time
   uint retime;                 // process ready time
   uint rutime;                 // process running time
+  int vfork;                   // If non-zero, running in the parent's memory (see vfork)
+  int pgid;                    // Process group (see setpgid)
+  uint sigpend;                // Pending signals, SIGBIT(sig) each (see signal.h)
+  int stopped;                 // If non-zero, stopped (or to stop) by SIGTSTP
+  uint sigmask;                // Blocked signals, as in sigpend
+  uint sighand[32];            // Handler for each signal, or SIG_DFL or SIG_IGN
+  int stopreport;              // If non-zero, waitpid has yet to report the stop
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -0,0 +1,716 @@
+// Shell.
+
+#include "types.h"
+#include "user.h"
+#include "fcntl.h"
+#include "ioctl.h"
+#include "signal.h"
+
+// Parsed command representation
+#define EXEC  1
+#define REDIR 2
+#define PIPE  3
+#define LIST  4
+#define BACK  5
+
+#define MAXARGS 10
+
+struct cmd {
+  int type;
+};
+
+struct execcmd {
+  int type;
+  char *argv[MAXARGS];
+  char *eargv[MAXARGS];
+};
+
+struct redircmd {
+  int type;
+  struct cmd *cmd;
+  char *file;
+  char *efile;
+  int mode;
+  int fd;
+};
+
+struct pipecmd {
+  int type;
+  struct cmd *left;
+  struct cmd *right;
+};
+
+struct listcmd {
+  int type;
+  struct cmd *left;
+  struct cmd *right;
+};
+
+struct backcmd {
+  int type;
+  struct cmd *cmd;
+};
+
+int execs(struct cmd*);
+int forked(int);
+void panic(char*);
+struct cmd *parsecmd(char*);
+void freecmd(struct cmd*);
+
+// Start a child to run cmd. If it goes straight to exec, vfork
+// saves copying our memory; the child only uses the stack below
+// ours until then. Anything else gets a real fork, as a vfork
+// would hold us up until it finished: with a pipe that could be
+// forever, if the other side is never started. A macro, because
+// the child of a vfork must not return from the caller of vfork.
+#define spawn(cmd) forked(execs(cmd) ? vfork() : fork())
+
+// Execute cmd.  Never returns.
+void
+runcmd(struct cmd *cmd)
+{
+  int p[2];
+  struct backcmd *bcmd;
+  struct execcmd *ecmd;
+  struct listcmd *lcmd;
+  struct pipecmd *pcmd;
+  struct redircmd *rcmd;
+
+  if(cmd == 0)
+    exit();
+
+  switch(cmd->type){
+  default:
+    panic("runcmd");
+
+  case EXEC:
+    ecmd = (struct execcmd*)cmd;
+    if(ecmd->argv[0] == 0)
+      exit();
+    exec(ecmd->argv[0], ecmd->argv);
+    printf(2, "exec %s failed\n", ecmd->argv[0]);
+    break;
+
+  case REDIR:
+    rcmd = (struct redircmd*)cmd;
+    close(rcmd->fd);
+    if(open(rcmd->file, rcmd->mode) < 0){
+      printf(2, "open %s failed\n", rcmd->file);
+      exit();
+    }
+    runcmd(rcmd->cmd);
+    break;
+
+  case LIST:
+    lcmd = (struct listcmd*)cmd;
+    if(spawn(lcmd->left) == 0)
+      runcmd(lcmd->left);
+    wait();
+    runcmd(lcmd->right);
+    break;
+
+  case PIPE:
+    pcmd = (struct pipecmd*)cmd;
+    if(pipe(p) < 0)
+      panic("pipe");
+    if(spawn(pcmd->left) == 0){
+      close(1);
+      dup(p[1]);
+      close(p[0]);
+      close(p[1]);
+      runcmd(pcmd->left);
+    }
+    if(spawn(pcmd->right) == 0){
+      close(0);
+      dup(p[0]);
+      close(p[0]);
+      close(p[1]);
+      runcmd(pcmd->right);
+    }
+    close(p[0]);
+    close(p[1]);
+    wait();
+    wait();
+    break;
+
+  case BACK:
+    bcmd = (struct backcmd*)cmd;
+    if(spawn(bcmd->cmd) == 0)
+      runcmd(bcmd->cmd);
+    break;
+  }
+  exit();
+}
+
+int
+getcmd(char *buf, int nbuf)
+{
+  printf(2, "$ ");
+  memset(buf, 0, nbuf);
+  gets(buf, nbuf);
+  if(buf[0] == 0) // EOF
+    return -1;
+  return 0;
+}
+char getHistoryCommand[INPUT_BUF];
+
+void printHistory(){
+  uint i ;
+  uint count = 0;
+  for(i= 0; i <MAX_HISTORY; i++){
+    if(history(getHistoryCommand, i) == 0){
+      count++;
+      printf(1, "%d: %s\n", count, getHistoryCommand);
+    }
+  }
+  return;
+}
+
+//PAGEBREAK!
+// Job control. Each command line runs as a job: a process group
+// led by the child that runs the line. The shell waits for the
+// foreground job, and meanwhile the console sends it ^C and ^Z
+// as signals (see ioctl.h). A line ending in & runs in the
+// background; when such jobs finish, they are reported before
+// the next prompt.
+
+#define NJOB 16
+
+struct job {
+  int pid;        // leader, and so group id; 0 if the slot is free
+  int stopped;    // if non-zero, stopped by ^Z
+  char line[64];  // the command line, for jobs
+} jobs[NJOB];
+
+// Return a free job slot, or 0 if all are taken.
+struct job*
+jobfree(void)
+{
+  struct job *j;
+
+  for(j = jobs; j < jobs+NJOB; j++)
+    if(j->pid == 0)
+      return j;
+  return 0;
+}
+
+void
+jobprint(struct job *j, char *state)
+{
+  printf(2, "[%d] %s %s\n", (int)(j - jobs) + 1, state, j->line);
+}
+
+// Report and forget the background jobs that have finished.
+void
+jobreap(void)
+{
+  struct job *j;
+  int pid, st;
+
+  while((pid = waitpid(-1, &st, WNOHANG)) > 0){
+    for(j = jobs; j < jobs+NJOB; j++){
+      if(j->pid == pid){
+        jobprint(j, "Done   ");
+        j->pid = 0;
+      }
+    }
+  }
+}
+
+// Wait for job j in the foreground until it finishes or stops.
+void
+jobfg(struct job *j)
+{
+  int st;
+
+  ioctl(0, CONS_FGPGRP, j->pid);
+  if(waitpid(j->pid, &st, WUNTRACED) < 0)
+    st = WEXITED;
+  ioctl(0, CONS_FGPGRP, 0);
+  if(st == WSTOPPED){
+    j->stopped = 1;
+    write(2, "\n", 1);
+    jobprint(j, "Stopped");
+  } else
+    j->pid = 0;
+}
+
+// Carry out buf if it is one of the builtins "jobs", "fg [n]" and
+// "bg [n]", where n (or %n) is a job number, by default the last.
+// Returns 0 if it is not.
+int
+jobcmd(char *buf)
+{
+  struct job *j, *jn;
+  char *arg;
+  int n;
+
+  if(strcmp(buf, "jobs\n") == 0){
+    for(j = jobs; j < jobs+NJOB; j++)
+      if(j->pid)
+        jobprint(j, j->stopped ? "Stopped" : "Running");
+    return 1;
+  }
+  if((buf[0] != 'f' && buf[0] != 'b') || buf[1] != 'g' ||
+     (buf[2] != '\n' && buf[2] != ' '))
+    return 0;
+
+  for(arg = buf+2; *arg == ' '; arg++)
+    ;
+  if(*arg == '%')
+    arg++;
+  j = 0;
+  if(*arg >= '0' && *arg <= '9'){
+    if((n = atoi(arg)) >= 1 && n <= NJOB && jobs[n-1].pid)
+      j = &jobs[n-1];
+  } else {
+    for(jn = jobs; jn < jobs+NJOB; jn++)
+      if(jn->pid)
+        j = jn;
+  }
+  if(j == 0){
+    printf(2, "%c%c: no such job\n", buf[0], buf[1]);
+    return 1;
+  }
+
+  j->stopped = 0;
+  sigsend(-j->pid, SIGCONT);
+  if(buf[0] == 'f'){
+    printf(2, "%s\n", j->line);
+    jobfg(j);
+  } else
+    jobprint(j, "Running");
+  return 1;
+}
+
+int
+main(void)
+{
+  static char buf[100];
+  struct cmd *line, *cmd;
+  struct job *j;
+  int fd, pid, bg, n;
+
+  // Ensure that three file descriptors are open.
+  while((fd = open("console", O_RDWR)) >= 0){
+    if(fd >= 3){
+      close(fd);
+      break;
+    }
+  }
+
+  // Read and run input commands.
+  for(;;){
+    jobreap();
+    if(getcmd(buf, sizeof(buf)) < 0)
+      break;
+    if(buf[0] == 'c' && buf[1] == 'd' && buf[2] == ' '){
+      // Chdir must be called by the parent, not the child.
+      buf[strlen(buf)-1] = 0;  // chop \n
+      if(chdir(buf+3) < 0)
+        printf(2, "cannot cd %s\n", buf+3);
+      continue;
+    }
+    if(buf[0] == 'h' && buf[1] == 'i' && buf[2] == 's'  && buf[3] == 't' && buf[4] == 'o' && buf[5] == 'r' && buf[6] == 'y' && buf[7] == '\n'){
+      printHistory();
+      continue;
+    }
+    if(jobcmd(buf))
+      continue;
+    if((j = jobfree()) == 0){
+      printf(2, "too many jobs\n");
+      continue;
+    }
+    n = strlen(buf) - 1;  // chop \n
+    if(n >= sizeof(j->line))
+      n = sizeof(j->line) - 1;
+    memmove(j->line, buf, n);
+    j->line[n] = 0;
+
+    // Parse here: the child may borrow our memory (see spawn).
+    // Once spawn returns here the child has exec'd or has its own
+    // copy, so the tree can go.
+    line = parsecmd(buf);
+    bg = line->type == BACK;
+    cmd = bg ? ((struct backcmd*)line)->cmd : line;
+    if((pid = spawn(cmd)) == 0){
+      setpgid(0, 0);
+      runcmd(cmd);
+    }
+    freecmd(line);
+    setpgid(pid, pid);  // in case the child has yet to run
+    j->pid = pid;
+    j->stopped = 0;
+    if(bg)
+      printf(2, "[%d] %d\n", (int)(j - jobs) + 1, pid);
+    else
+      jobfg(j);
+  }
+  exit();
+}
+
+void
+panic(char *s)
+{
+  printf(2, "%s\n", s);
+  exit();
+}
+
+// Whether running cmd goes straight to exec.
+int
+execs(struct cmd *cmd)
+{
+  while(cmd->type == REDIR)
+    cmd = ((struct redircmd*)cmd)->cmd;
+  return cmd->type == EXEC;
+}
+
+// Return pid, from fork or vfork, but panic on failure.
+int
+forked(int pid)
+{
+  if(pid == -1)
+    panic("fork");
+  return pid;
+}
+
+//PAGEBREAK!
+// Constructors
+
+struct cmd*
+execcmd(void)
+{
+  struct execcmd *cmd;
+
+  cmd = malloc(sizeof(*cmd));
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = EXEC;
+  return (struct cmd*)cmd;
+}
+
+struct cmd*
+redircmd(struct cmd *subcmd, char *file, char *efile, int mode, int fd)
+{
+  struct redircmd *cmd;
+
+  cmd = malloc(sizeof(*cmd));
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = REDIR;
+  cmd->cmd = subcmd;
+  cmd->file = file;
+  cmd->efile = efile;
+  cmd->mode = mode;
+  cmd->fd = fd;
+  return (struct cmd*)cmd;
+}
+
+struct cmd*
+pipecmd(struct cmd *left, struct cmd *right)
+{
+  struct pipecmd *cmd;
+
+  cmd = malloc(sizeof(*cmd));
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = PIPE;
+  cmd->left = left;
+  cmd->right = right;
+  return (struct cmd*)cmd;
+}
+
+struct cmd*
+listcmd(struct cmd *left, struct cmd *right)
+{
+  struct listcmd *cmd;
+
+  cmd = malloc(sizeof(*cmd));
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = LIST;
+  cmd->left = left;
+  cmd->right = right;
+  return (struct cmd*)cmd;
+}
+
+struct cmd*
+backcmd(struct cmd *subcmd)
+{
+  struct backcmd *cmd;
+
+  cmd = malloc(sizeof(*cmd));
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->type = BACK;
+  cmd->cmd = subcmd;
+  return (struct cmd*)cmd;
+}
+//PAGEBREAK!
+// Parsing
+
+char whitespace[] = " \t\r\n\v";
+char symbols[] = "<|>&;()";
+
+int
+gettoken(char **ps, char *es, char **q, char **eq)
+{
+  char *s;
+  int ret;
+
+  s = *ps;
+  while(s < es && strchr(whitespace, *s))
+    s++;
+  if(q)
+    *q = s;
+  ret = *s;
+  switch(*s){
+  case 0:
+    break;
+  case '|':
+  case '(':
+  case ')':
+  case ';':
+  case '&':
+  case '<':
+    s++;
+    break;
+  case '>':
+    s++;
+    if(*s == '>'){
+      ret = '+';
+      s++;
+    }
+    break;
+  default:
+    ret = 'a';
+    while(s < es && !strchr(whitespace, *s) && !strchr(symbols, *s))
+      s++;
+    break;
+  }
+  if(eq)
+    *eq = s;
+
+  while(s < es && strchr(whitespace, *s))
+    s++;
+  *ps = s;
+  return ret;
+}
+
+int
+peek(char **ps, char *es, char *toks)
+{
+  char *s;
+
+  s = *ps;
+  while(s < es && strchr(whitespace, *s))
+    s++;
+  *ps = s;
+  return *s && strchr(toks, *s);
+}
+
+struct cmd *parseline(char**, char*);
+struct cmd *parsepipe(char**, char*);
+struct cmd *parseexec(char**, char*);
+struct cmd *nulterminate(struct cmd*);
+
+struct cmd*
+parsecmd(char *s)
+{
+  char *es;
+  struct cmd *cmd;
+
+  es = s + strlen(s);
+  cmd = parseline(&s, es);
+  peek(&s, es, "");
+  if(s != es){
+    printf(2, "leftovers: %s\n", s);
+    panic("syntax");
+  }
+  nulterminate(cmd);
+  return cmd;
+}
+
+struct cmd*
+parseline(char **ps, char *es)
+{
+  struct cmd *cmd;
+
+  cmd = parsepipe(ps, es);
+  while(peek(ps, es, "&")){
+    gettoken(ps, es, 0, 0);
+    cmd = backcmd(cmd);
+  }
+  if(peek(ps, es, ";")){
+    gettoken(ps, es, 0, 0);
+    cmd = listcmd(cmd, parseline(ps, es));
+  }
+  return cmd;
+}
+
+struct cmd*
+parsepipe(char **ps, char *es)
+{
+  struct cmd *cmd;
+
+  cmd = parseexec(ps, es);
+  if(peek(ps, es, "|")){
+    gettoken(ps, es, 0, 0);
+    cmd = pipecmd(cmd, parsepipe(ps, es));
+  }
+  return cmd;
+}
+
+struct cmd*
+parseredirs(struct cmd *cmd, char **ps, char *es)
+{
+  int tok;
+  char *q, *eq;
+
+  while(peek(ps, es, "<>")){
+    tok = gettoken(ps, es, 0, 0);
+    if(gettoken(ps, es, &q, &eq) != 'a')
+      panic("missing file for redirection");
+    switch(tok){
+    case '<':
+      cmd = redircmd(cmd, q, eq, O_RDONLY, 0);
+      break;
+    case '>':
+      cmd = redircmd(cmd, q, eq, O_WRONLY|O_CREATE, 1);
+      break;
+    case '+':  // >>
+      cmd = redircmd(cmd, q, eq, O_WRONLY|O_CREATE, 1);
+      break;
+    }
+  }
+  return cmd;
+}
+
+struct cmd*
+parseblock(char **ps, char *es)
+{
+  struct cmd *cmd;
+
+  if(!peek(ps, es, "("))
+    panic("parseblock");
+  gettoken(ps, es, 0, 0);
+  cmd = parseline(ps, es);
+  if(!peek(ps, es, ")"))
+    panic("syntax - missing )");
+  gettoken(ps, es, 0, 0);
+  cmd = parseredirs(cmd, ps, es);
+  return cmd;
+}
+
+struct cmd*
+parseexec(char **ps, char *es)
+{
+  char *q, *eq;
+  int tok, argc;
+  struct execcmd *cmd;
+  struct cmd *ret;
+
+  if(peek(ps, es, "("))
+    return parseblock(ps, es);
+
+  ret = execcmd();
+  cmd = (struct execcmd*)ret;
+
+  argc = 0;
+  ret = parseredirs(ret, ps, es);
+  while(!peek(ps, es, "|)&;")){
+    if((tok=gettoken(ps, es, &q, &eq)) == 0)
+      break;
+    if(tok != 'a')
+      panic("syntax");
+    cmd->argv[argc] = q;
+    cmd->eargv[argc] = eq;
+    argc++;
+    if(argc >= MAXARGS)
+      panic("too many args");
+    ret = parseredirs(ret, ps, es);
+  }
+  cmd->argv[argc] = 0;
+  cmd->eargv[argc] = 0;
+  return ret;
+}
+
+// NUL-terminate all the counted strings.
+struct cmd*
+nulterminate(struct cmd *cmd)
+{
+  int i;
+  struct backcmd *bcmd;
+  struct execcmd *ecmd;
+  struct listcmd *lcmd;
+  struct pipecmd *pcmd;
+  struct redircmd *rcmd;
+
+  if(cmd == 0)
+    return 0;
+
+  switch(cmd->type){
+  case EXEC:
+    ecmd = (struct execcmd*)cmd;
+    for(i=0; ecmd->argv[i]; i++)
+      *ecmd->eargv[i] = 0;
+    break;
+
+  case REDIR:
+    rcmd = (struct redircmd*)cmd;
+    nulterminate(rcmd->cmd);
+    *rcmd->efile = 0;
+    break;
+
+  case PIPE:
+    pcmd = (struct pipecmd*)cmd;
+    nulterminate(pcmd->left);
+    nulterminate(pcmd->right);
+    break;
+
+  case LIST:
+    lcmd = (struct listcmd*)cmd;
+    nulterminate(lcmd->left);
+    nulterminate(lcmd->right);
+    break;
+
+  case BACK:
+    bcmd = (struct backcmd*)cmd;
+    nulterminate(bcmd->cmd);
+    break;
+  }
+  return cmd;
+}
+
+// Free cmd and the commands it contains.
+void
+freecmd(struct cmd *cmd)
+{
+  struct backcmd *bcmd;
+  struct listcmd *lcmd;
+  struct pipecmd *pcmd;
+  struct redircmd *rcmd;
+
+  if(cmd == 0)
+    return;
+
+  switch(cmd->type){
+  case REDIR:
+    rcmd = (struct redircmd*)cmd;
+    freecmd(rcmd->cmd);
+    break;
+
+  case PIPE:
+    pcmd = (struct pipecmd*)cmd;
+    freecmd(pcmd->left);
+    freecmd(pcmd->right);
+    break;
+
+  case LIST:
+    lcmd = (struct listcmd*)cmd;
+    freecmd(lcmd->left);
+    freecmd(lcmd->right);
+    break;
+
+  case BACK:
+    bcmd = (struct backcmd*)cmd;
+    freecmd(bcmd->cmd);
+    break;
+  }
+  free(cmd);
+}
@@ -0,0 +1,47 @@
+// Shell throughput: "shbench [n]" writes a script of n (default 1000)
+// commands, runs it through sh, and prints the ticks it took.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fcntl.h"
+
+char *shargv[] = { "sh", 0 };
+
+int
+main(int argc, char *argv[])
+{
+  int fd, i, n, t0;
+
+  n = 1000;
+  if(argc > 1)
+    n = atoi(argv[1]);
+
+  fd = open("shbench.sh", O_CREATE | O_RDWR);
+  if(fd < 0){
+    printf(2, "shbench: cannot create shbench.sh\n");
+    exit();
+  }
+  for(i = 0; i < n; i++)
+    write(fd, "echo hi\n", 8);
+  close(fd);
+
+  t0 = uptime();
+  if(fork() == 0){
+    close(0);
+    open("shbench.sh", O_RDONLY);
+    close(1);
+    open("shbench.out", O_CREATE | O_WRONLY);
+    close(2);
+    dup(1);
+    exec("sh", shargv);
+    printf(2, "shbench: exec sh failed\n");
+    exit();
+  }
+  wait();
+  printf(1, "%d commands in %d ticks\n", n, uptime() - t0);
+
+  unlink("shbench.sh");
+  unlink("shbench.out");
+  exit();
+}
@@ -0,0 +1,27 @@
+// Signals, sent with sigsend(). A process can catch or ignore each
+// but SIGKILL with signal(). Uncaught, SIGCHLD is ignored, SIGTSTP
+// stops the process, SIGCONT lets a stopped process go on, and the
+// rest kill it.
+#define SIGINT   2
+#define SIGKILL  9
+#define SIGUSR1 10
+#define SIGUSR2 12
+#define SIGTERM 15
+#define SIGCHLD 17  // a child has exited
+#define SIGCONT 18
+#define SIGTSTP 20
+
+#define NSIG    32  // one bit each in a uint
+#define SIGBIT(sig) (1 << (sig))
+
+// Handlers for signal() besides functions.
+#define SIG_DFL ((void (*)(int))0)  // the action above
+#define SIG_IGN ((void (*)(int))1)  // nothing
+
+// waitpid() options.
+#define WNOHANG    1  // return 0 rather than wait
+#define WUNTRACED  2  // also return for a child that has stopped
+
+// Status set by waitpid().
+#define WEXITED    0  // the child has exited
+#define WSTOPPED   1  // the child has stopped
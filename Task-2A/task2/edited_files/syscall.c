@@ -105,7 +105,14 @@ extern int sys_write(void);
 extern int sys_uptime(void);
 extern int sys_draw(void);
 extern int sys_history(void);
-extern int sys_wait2(void);    
+extern int sys_wait2(void);
+extern int sys_vfork(void);
+extern int sys_waitpid(void);
+extern int sys_setpgid(void);
+extern int sys_sigsend(void);
+extern int sys_ioctl(void);
+extern int sys_signal(void);
+extern int sys_sigreturn(void);    
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -134,6 +141,13 @@ static int (*syscalls[])(void) = {
 // adding system call history
 [SYS_history] sys_history,
 [SYS_wait2]   sys_wait2,
+[SYS_vfork]   sys_vfork,
+[SYS_waitpid] sys_waitpid,
+[SYS_setpgid] sys_setpgid,
+[SYS_sigsend] sys_sigsend,
+[SYS_ioctl]   sys_ioctl,
+[SYS_signal]  sys_signal,
+[SYS_sigreturn] sys_sigreturn,
 };
 
 void
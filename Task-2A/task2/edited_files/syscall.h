@@ -24,3 +24,10 @@
 #define SYS_draw 22
 #define SYS_history 23
 #define SYS_wait2  24
+#define SYS_vfork  25
+#define SYS_waitpid 26
+#define SYS_setpgid 27
+#define SYS_sigsend 28
+#define SYS_ioctl 29
+#define SYS_signal 30
+#define SYS_sigreturn 31
@@ -6,6 +6,11 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "proc.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "file.h"
+#include "stat.h"
 #include "ASCII_image.h"
 int
 sys_fork(void)
@@ -13,6 +18,62 @@ sys_fork(void)
   return fork();
 }
 
+// See vfork() in proc.c, and its stub in usys.S.
+int
+sys_vfork(void)
+{
+  return vfork();
+}
+
+int
+sys_waitpid(void)
+{
+  int pid, options;
+  int *status;
+
+  if(argint(0, &pid) < 0 || argptr(1, (void*)&status, sizeof(*status)) < 0 ||
+     argint(2, &options) < 0)
+    return -1;
+  return waitpid(pid, status, options);
+}
+
+int
+sys_setpgid(void)
+{
+  int pid, pgid;
+
+  if(argint(0, &pid) < 0 || argint(1, &pgid) < 0)
+    return -1;
+  return setpgid(pid, pgid);
+}
+
+int
+sys_sigsend(void)
+{
+  int pid, sig;
+
+  if(argint(0, &pid) < 0 || argint(1, &sig) < 0)
+    return -1;
+  return sigsend(pid, sig);
+}
+
+int
+sys_signal(void)
+{
+  int sig, h;
+
+  if(argint(0, &sig) < 0 || argint(1, &h) < 0)
+    return -1;
+  return signal(sig, h);
+}
+
+// Called by the code sigcheck() puts on the user stack (see proc.c).
+int
+sys_sigreturn(void)
+{
+  return sigreturn();
+}
+
 int
 sys_exit(void)
 {
@@ -149,6 +210,28 @@ int sys_history(void) {
   return history(buffer, historyId);
 }
 
+// Device-specific request on an open device file.
+// Only the console has any (see ioctl.h).
+int
+sys_ioctl(void)
+{
+  struct file *f;
+  int fd, req, arg, isconsole;
+
+  if(argint(0, &fd) < 0 || argint(1, &req) < 0 || argint(2, &arg) < 0)
+    return -1;
+  if(fd < 0 || fd >= NOFILE || (f = myproc()->ofile[fd]) == 0)
+    return -1;
+  if(f->type != FD_INODE)
+    return -1;
+  ilock(f->ip);
+  isconsole = f->ip->type == T_DEV && f->ip->major == CONSOLE;
+  iunlock(f->ip);
+  if(!isconsole)
+    return -1;
+  return consoleioctl(req, arg);
+}
+
 
 int sys_wait2(void) {
   int *retime, *rutime, *stime;
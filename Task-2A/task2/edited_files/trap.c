@@ -41,6 +41,8 @@ trap(struct trapframe *tf)
       exit();
     myproc()->tf = tf;
     syscall();
+    if((myproc()->sigpend & ~myproc()->sigmask) || myproc()->stopped)
+      sigcheck(tf);
     if(myproc()->killed)
       exit();
     return;
@@ -107,6 +109,12 @@ trap(struct trapframe *tf)
      tf->trapno == T_IRQ0+IRQ_TIMER)
     yield();
 
+  // On the way back to user space, stop or run a signal handler
+  // if asked to.
+  if(myproc() && (tf->cs&3) == DPL_USER &&
+     ((myproc()->sigpend & ~myproc()->sigmask) || myproc()->stopped))
+    sigcheck(tf);
+
   // Check if the process has been killed since we yielded
   if(myproc() && myproc()->killed && (tf->cs&3) == DPL_USER)
     exit();
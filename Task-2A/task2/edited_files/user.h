@@ -28,6 +28,12 @@ int draw(void *buf, uint size);
 // system call which print last 16 commands executed.
 int history(char *buf, uint historyId);
 int wait2(int*, int*, int*);
+int vfork(void);
+int waitpid(int, int*, int);
+int setpgid(int, int);
+int sigsend(int, int);
+int ioctl(int, int, int);
+int signal(int, void (*)(int));
 
 // ulib.c
 int stat(const char*, struct stat*);
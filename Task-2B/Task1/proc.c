@@ -565,7 +565,6 @@ scheduler(void)
       switchuvm(p);
       p->state = RUNNING;
       swtch(&c->scheduler, p->context);
-      switchkvm();
 
       // Process is done running for now.
       // It should have changed its p->state before coming back.
@@ -593,7 +592,6 @@ scheduler(void)
       switchuvm(oldest_proc);
       oldest_proc->state = RUNNING;
       swtch(&(c->scheduler), oldest_proc->context);
-      switchkvm();
     }
 
     // Process is done running for now.
@@ -611,7 +609,6 @@ scheduler(void)
       switchuvm(p);
       p->state = RUNNING;
       swtch(&(c->scheduler), p->context);
-      switchkvm();
     }
     // Process is done running for now.
     // It should have changed its p->state before coming back.
@@ -628,13 +625,18 @@ scheduler(void)
       switchuvm(p);
       p->state = RUNNING;
       swtch(&(c->scheduler), p->context);
-      switchkvm();
     }
     // Process is done running for now.
     // It should have changed its p->state before coming back.
     c->proc = 0;
     #endif
 
+    // The scheduler stays on the last process's page directory instead
+    // of calling switchkvm() after every swtch(): the kernel mappings are
+    // the same in every page directory. Once ptable.lock is dropped another
+    // CPU may run, exec or reap that process and free its page directory.
+    if(ncpu > 1)
+      switchkvm();
     release(&ptable.lock);
 
   }
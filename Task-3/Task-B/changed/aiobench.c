@@ -0,0 +1,124 @@
+// I/O ring against plain system calls: "aiobench [kbytes]" writes a
+// file of kbytes (default 512) and reads it back in 512-byte blocks,
+// once with one pwrite()/pread() per block and once through an I/O
+// ring, a batch of blocks per ioring_enter(), then prints the ticks
+// and the system call traps each took.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fcntl.h"
+#include "ioring.h"
+
+#define BSIZE 512
+#define BATCH 32
+
+char buf[BATCH][BSIZE];
+
+// Move nblocks blocks between fd and buf with one system call each.
+int
+plain(int fd, int op, int nblocks)
+{
+  int i, n;
+
+  for(i = 0; i < nblocks; i++){
+    if(op == IORING_OP_WRITE)
+      n = pwrite(fd, buf[i % BATCH], BSIZE, i*BSIZE);
+    else
+      n = pread(fd, buf[i % BATCH], BSIZE, i*BSIZE);
+    if(n != BSIZE){
+      printf(2, "aiobench: block %d failed\n", i);
+      exit();
+    }
+  }
+  return nblocks;
+}
+
+// Move nblocks blocks through ring r, BATCH per ioring_enter(),
+// and fsync the writes. Returns the number of traps.
+int
+ringed(struct ioring *r, int fd, int op, int nblocks)
+{
+  struct io_sqe *s;
+  struct io_cqe *e;
+  int i, j, n, m, traps;
+
+  traps = 0;
+  for(i = 0; i < nblocks; i += n){
+    n = nblocks - i < BATCH ? nblocks - i : BATCH;
+    for(j = 0; j < n; j++){
+      s = &r->sq[r->sqtail % IORING_SQ];
+      s->op = op;
+      s->fd = fd;
+      s->buf = buf[j];
+      s->len = BSIZE;
+      s->off = (i+j) * BSIZE;
+      s->data = i+j;
+      r->sqtail++;
+    }
+    m = n;
+    if(op == IORING_OP_WRITE && i + n == nblocks){
+      s = &r->sq[r->sqtail % IORING_SQ];
+      s->op = IORING_OP_FSYNC;
+      s->fd = fd;
+      s->data = nblocks;
+      r->sqtail++;
+      m++;
+    }
+    ioring_enter(m);
+    traps++;
+    for(j = 0; j < m; j++){
+      while(r->cqhead == r->cqtail){
+        ioring_enter(1);
+        traps++;
+      }
+      e = &r->cq[r->cqhead % IORING_CQ];
+      if(e->res < 0 || (e->data < nblocks && e->res != BSIZE)){
+        printf(2, "aiobench: request %d failed\n", e->data);
+        exit();
+      }
+      r->cqhead++;
+    }
+  }
+  return traps;
+}
+
+int
+main(int argc, char *argv[])
+{
+  struct ioring *r;
+  int fd, kbytes, nblocks, t0, traps;
+
+  kbytes = 512;
+  if(argc > 1)
+    kbytes = atoi(argv[1]);
+  nblocks = kbytes*1024 / BSIZE;
+  memset(buf, 'a', sizeof(buf));
+
+  if((r = ioring_setup()) == (struct ioring*)-1){
+    printf(2, "aiobench: ioring_setup failed\n");
+    exit();
+  }
+  if((fd = open("aiobench.dat", O_CREATE | O_RDWR)) < 0){
+    printf(2, "aiobench: cannot create aiobench.dat\n");
+    exit();
+  }
+
+  t0 = uptime();
+  traps = plain(fd, IORING_OP_WRITE, nblocks);
+  printf(1, "pwrite: %d blocks in %d ticks, %d traps\n", nblocks, uptime() - t0, traps);
+  t0 = uptime();
+  traps = plain(fd, IORING_OP_READ, nblocks);
+  printf(1, "pread: %d blocks in %d ticks, %d traps\n", nblocks, uptime() - t0, traps);
+
+  t0 = uptime();
+  traps = ringed(r, fd, IORING_OP_WRITE, nblocks);
+  printf(1, "ring write: %d blocks in %d ticks, %d traps\n", nblocks, uptime() - t0, traps);
+  t0 = uptime();
+  traps = ringed(r, fd, IORING_OP_READ, nblocks);
+  printf(1, "ring read: %d blocks in %d ticks, %d traps\n", nblocks, uptime() - t0, traps);
+
+  close(fd);
+  unlink("aiobench.dat");
+  exit();
+}
@@ -0,0 +1,321 @@
+// Buffer cache.
+//
+// The buffer cache holds cached copies of disk block contents.
+// Caching disk blocks in memory reduces the number of disk reads
+// and also provides a synchronization point for disk blocks used
+// by multiple processes.
+//
+// Interface:
+// * To get a buffer for a particular disk block, call bread.
+// * After changing buffer data, call bwrite to write it to disk.
+// * When done with the buffer, call brelse.
+// * Do not use the buffer after calling brelse.
+// * Only one process at a time can use a buffer,
+//     so do not keep them longer than necessary.
+//
+// The implementation uses two state flags internally:
+// * B_VALID: the buffer data has been read from the disk.
+// * B_DIRTY: the buffer data has been modified
+//     and needs to be written to disk.
+//
+// The buffers are hashed by block number into NBUCKET lists, each
+// with its own lock, so lookups of different blocks do not contend.
+// A miss recycles the least recently released unused buffer of any
+// bucket; bcache.lock serializes misses so that a block is never
+// cached twice. The number of buffers is set at boot from the
+// amount of physical memory.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "buf.h"
+#include "iostat.h"
+
+#define NBUCKET 61
+
+struct bucket {
+  struct spinlock lock;
+  struct buf head;    // circular list of the buffers hashed here
+  uint hits;
+};
+
+struct {
+  struct spinlock lock;  // serializes misses
+  int nbuf;
+  uint misses;
+  uint evictions;
+  uint readahead;
+  struct bucket bucket[NBUCKET];
+} bcache;
+
+static struct bucket*
+bucketof(uint dev, uint blockno)
+{
+  return &bcache.bucket[(dev*31 + blockno) % NBUCKET];
+}
+
+static void
+bucketadd(struct bucket *bk, struct buf *b)
+{
+  b->next = bk->head.next;
+  b->prev = &bk->head;
+  bk->head.next->prev = b;
+  bk->head.next = b;
+}
+
+// Give the cache 1/BCACHEDIV of physical memory, but at least NBUF
+// buffers. Runs before kinit2(), so the pages must come from the
+// first 4MB.
+void
+binit(void)
+{
+  struct bucket *bk;
+  struct buf *b;
+  char *page;
+  int i, n;
+
+  initlock(&bcache.lock, "bcache");
+  for(bk = bcache.bucket; bk < bcache.bucket+NBUCKET; bk++){
+    initlock(&bk->lock, "bcache.bucket");
+    bk->head.prev = &bk->head;
+    bk->head.next = &bk->head;
+  }
+
+  n = PHYSTOP / BCACHEDIV / sizeof(struct buf);
+  if(n < NBUF)
+    n = NBUF;
+  while(bcache.nbuf < n){
+    if((page = kalloc()) == 0)
+      break;
+    for(i = 0; i < PGSIZE/sizeof(struct buf) && bcache.nbuf < n; i++){
+      b = (struct buf*)page + i;
+      memset(b, 0, sizeof(*b));
+      initsleeplock(&b->lock, "buffer");
+      bucketadd(&bcache.bucket[bcache.nbuf % NBUCKET], b);
+      bcache.nbuf++;
+    }
+  }
+  if(bcache.nbuf < NBUF)
+    panic("binit");
+}
+
+// Look through buffer cache for block on device dev.
+// If not found, allocate a buffer.
+// In either case, return locked buffer. For readahead, return 0
+// instead of panicking if every buffer is in use.
+static struct buf*
+bget(uint dev, uint blockno, int readahead)
+{
+  struct bucket *bk, *vbk, *k;
+  struct buf *b, *victim;
+
+  bk = bucketof(dev, blockno);
+
+  // Is the block already cached?
+  acquire(&bk->lock);
+  for(b = bk->head.next; b != &bk->head; b = b->next){
+    if(b->dev == dev && b->blockno == blockno){
+      b->refcnt++;
+      bk->hits++;
+      release(&bk->lock);
+      acquiresleep(&b->lock);
+      return b;
+    }
+  }
+  release(&bk->lock);
+
+  // Not cached. Only one miss at a time from here on, and look
+  // again: the block may have been read in meanwhile.
+  acquire(&bcache.lock);
+  acquire(&bk->lock);
+  for(b = bk->head.next; b != &bk->head; b = b->next){
+    if(b->dev == dev && b->blockno == blockno){
+      b->refcnt++;
+      bk->hits++;
+      release(&bk->lock);
+      release(&bcache.lock);
+      acquiresleep(&b->lock);
+      return b;
+    }
+  }
+  release(&bk->lock);
+
+  // Recycle the least recently used unused buffer. Even if refcnt==0,
+  // B_DIRTY indicates a buffer is in use because log.c has modified
+  // it but not yet committed it. Only the lock of the bucket holding
+  // the best candidate so far is kept.
+  victim = 0;
+  vbk = 0;
+  for(k = bcache.bucket; k < bcache.bucket+NBUCKET; k++){
+    acquire(&k->lock);
+    int found = 0;
+    for(b = k->head.next; b != &k->head; b = b->next){
+      if(b->refcnt == 0 && (b->flags & B_DIRTY) == 0 &&
+         (victim == 0 || b->lastuse < victim->lastuse)){
+        victim = b;
+        found = 1;
+      }
+    }
+    if(found){
+      if(vbk)
+        release(&vbk->lock);
+      vbk = k;
+    } else
+      release(&k->lock);
+  }
+  if(victim == 0){
+    if(readahead){
+      release(&bcache.lock);
+      return 0;
+    }
+    panic("bget: no buffers");
+  }
+
+  if(victim->flags & B_VALID)
+    bcache.evictions++;
+  bcache.misses++;
+  victim->next->prev = victim->prev;
+  victim->prev->next = victim->next;
+  release(&vbk->lock);
+
+  victim->dev = dev;
+  victim->blockno = blockno;
+  victim->flags = 0;
+  victim->refcnt = 1;
+  acquire(&bk->lock);
+  bucketadd(bk, victim);
+  release(&bk->lock);
+  release(&bcache.lock);
+  acquiresleep(&victim->lock);
+  return victim;
+}
+
+// Return a locked buf with the contents of the indicated block.
+struct buf*
+bread(uint dev, uint blockno)
+{
+  struct buf *b;
+
+  b = bget(dev, blockno, 0);
+  if((b->flags & B_VALID) == 0) {
+    iderw(b);
+  }
+  return b;
+}
+
+// Write b's contents to disk.  Must be locked.
+void
+bwrite(struct buf *b)
+{
+  if(!holdingsleep(&b->lock))
+    panic("bwrite");
+  b->flags |= B_DIRTY;
+  iderw(b);
+}
+
+// Start writing b's contents to disk without waiting, so that
+// several writes can be outstanding. Must be locked, and must be
+// waited for with bwait() before brelse().
+void
+bwritestart(struct buf *b)
+{
+  if(!holdingsleep(&b->lock))
+    panic("bwritestart");
+  b->flags |= B_DIRTY;
+  idesubmit(b);
+}
+
+void
+bwait(struct buf *b)
+{
+  idecomplete(b);
+}
+
+// Start reading a block into the cache for readahead, without
+// waiting for it. The buffer stays locked, so a bread() of the
+// block sleeps until ideintr() has filled it and calls bdone().
+void
+bprefetch(uint dev, uint blockno)
+{
+  struct bucket *bk;
+  struct buf *b;
+
+  bk = bucketof(dev, blockno);
+  acquire(&bk->lock);
+  for(b = bk->head.next; b != &bk->head; b = b->next){
+    if(b->dev == dev && b->blockno == blockno){
+      release(&bk->lock);
+      return;
+    }
+  }
+  release(&bk->lock);
+
+  if((b = bget(dev, blockno, 1)) == 0)
+    return;
+  if(b->flags & B_VALID){
+    brelse(b);
+    return;
+  }
+  b->flags |= B_ASYNC;
+  bcache.readahead++;
+  idesubmit(b);
+}
+
+static void
+bunref(struct buf *b)
+{
+  struct bucket *bk;
+
+  bk = bucketof(b->dev, b->blockno);
+  acquire(&bk->lock);
+  b->refcnt--;
+  if (b->refcnt == 0) {
+    // no one is waiting for it.
+    b->lastuse = ticks;
+  }
+  release(&bk->lock);
+}
+
+// Release a locked buffer.
+// Record the release time for LRU eviction.
+void
+brelse(struct buf *b)
+{
+  if(!holdingsleep(&b->lock))
+    panic("brelse");
+
+  releasesleep(&b->lock);
+  bunref(b);
+}
+
+// Release a buffer read ahead by bprefetch(). Called by ideintr(),
+// not by the process that locked the buffer.
+void
+bdone(struct buf *b)
+{
+  b->flags &= ~B_ASYNC;
+  releasesleep(&b->lock);
+  bunref(b);
+}
+
+// Fill in the block cache part of st.
+void
+bstat(struct iostat *st)
+{
+  struct bucket *bk;
+
+  st->nbuf = bcache.nbuf;
+  st->bhits = 0;
+  for(bk = bcache.bucket; bk < bcache.bucket+NBUCKET; bk++)
+    st->bhits += bk->hits;
+  st->bmisses = bcache.misses;
+  st->bevictions = bcache.evictions;
+  st->breadahead = bcache.readahead;
+}
+//PAGEBREAK!
+// Blank page.
@@ -0,0 +1,15 @@
+struct buf {
+  int flags;
+  uint dev;
+  uint blockno;
+  struct sleeplock lock;
+  uint refcnt;
+  uint lastuse;      // ticks at last brelse, for LRU eviction
+  struct buf *prev;  // hash bucket list
+  struct buf *next;
+  struct buf *qnext; // disk queue
+  uchar data[BSIZE];
+};
+#define B_VALID 0x2  // buffer has been read from disk
+#define B_DIRTY 0x4  // buffer needs to be written to disk
+#define B_ASYNC 0x8  // ideintr() releases the buffer when done
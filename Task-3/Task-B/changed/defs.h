@@ -2,20 +2,30 @@ struct buf;
 struct context;
 struct file;
 struct inode;
+struct iostat;
+struct iovec;
 struct pipe;
 struct proc;
+struct procinfo;
 struct rtcdate;
 struct spinlock;
 struct sleeplock;
 struct stat;
 struct superblock;
 struct swap_req;
+struct vdso;
+struct vdsoproc;
 
 // bio.c
 void            binit(void);
 struct buf*     bread(uint, uint);
 void            brelse(struct buf*);
 void            bwrite(struct buf*);
+void            bstat(struct iostat*);
+void            bprefetch(uint, uint);
+void            bdone(struct buf*);
+void            bwritestart(struct buf*);
+void            bwait(struct buf*);
 
 // console.c
 void            consoleinit(void);
@@ -34,9 +44,15 @@ void            fileinit(void);
 int             fileread(struct file*, char*, int n);
 int             filestat(struct file*, struct stat*);
 int             filewrite(struct file*, char*, int n);
+int             filereadv(struct file*, struct iovec*, int);
+int             filewritev(struct file*, struct iovec*, int);
+int             filepread(struct file*, char*, int n, uint);
+int             filepwrite(struct file*, char*, int n, uint);
+int             filesplice(struct file*, struct file*, int n);
 
 // fs.c
 void            readsb(int dev, struct superblock *sb);
+void            dcachestat(struct iostat*);
 int             dirlink(struct inode*, char*, uint);
 struct inode*   dirlookup(struct inode*, char*, uint*);
 struct inode*   ialloc(uint, short);
@@ -53,17 +69,28 @@ struct inode*   nameiparent(char*, char*);
 int             readi(struct inode*, char*, uint, uint);
 void            stati(struct inode*, struct stat*);
 int             writei(struct inode*, char*, uint, uint);
+void            tmpmount(char*);
 
 // ide.c
 void            ideinit(void);
 void            ideintr(void);
 void            iderw(struct buf*);
+void            idesubmit(struct buf*);
+void            idecomplete(struct buf*);
+void            idestat(struct iostat*);
 
 // ioapic.c
 void            ioapicenable(int irq, int cpu);
 extern uchar    ioapicid;
 void            ioapicinit(void);
 
+// ioring.c
+void            ioringinit(void);
+int             ioringsetup(void);
+int             ioringenter(int);
+void            ioringfree(struct proc*);
+void            IORING_PROCESS(void);
+
 // kalloc.c
 char*           kalloc(void);
 void            kfree(char*);
@@ -85,6 +112,9 @@ void            microdelay(int);
 // log.c
 void            initlog(int dev);
 void            log_write(struct buf*);
+void            logstat(struct iostat*);
+void            logsync(void);
+void            LOG_COMMIT_PROCESS(void);
 void            begin_op();
 void            end_op();
 
@@ -99,8 +129,12 @@ void            picinit(void);
 // pipe.c
 int             pipealloc(struct file**, struct file**);
 void            pipeclose(struct pipe*, int);
-int             piperead(struct pipe*, char*, int);
-int             pipewrite(struct pipe*, char*, int);
+int             pipereadv(struct pipe*, struct iovec*, int);
+int             pipewritev(struct pipe*, struct iovec*, int);
+int             pipewbegin(struct pipe*, char**, int);
+void            pipewend(struct pipe*, int);
+int             piperbegin(struct pipe*, char**, int);
+void            piperend(struct pipe*, int);
 
 //PAGEBREAK: 16
 // proc.c
@@ -124,12 +158,15 @@ void            yield(void);
 void 	        create_kernel_process(const char *name, void (*entrypoint)());
 void 	        SWAP_OUT_PROCESS();
 void 	        SWAP_IN_PROCESS();
+void 	        PAGE_AGING_PROCESS();
 extern int      SOP_PRESENT; // swap out process is present or not
 extern int      SIP_PRESENT; // swap in process is present or not
 extern struct swap_req swap_out_req;
 extern struct swap_req swap_in_req;
 int swap_req_push(struct proc *p, struct swap_req *q);
 struct proc* swap_req_pop(struct swap_req *q);
+int             oom_kill(void);
+int             getprocinfo(int, struct procinfo*);
 
 // swtch.S
 void            swtch(struct context**, struct context*);
@@ -169,12 +206,22 @@ void            syscall(void);
 // timer.c
 void            timerinit(void);
 
+// tmpfs.c
+void            tmpfsinit(void);
+uint            tmpfsialloc(short);
+void            tmpfsiload(struct inode*);
+void            tmpfsiupdate(struct inode*);
+void            tmpfsitrunc(struct inode*);
+int             tmpfsread(struct inode*, char*, uint, uint);
+int             tmpfswrite(struct inode*, char*, uint, uint);
+
 // trap.c
 void            idtinit(void);
 extern uint     ticks;
 void            tvinit(void);
 extern struct spinlock tickslock;
 extern struct spinlock swapinlock;
+void            swapinpage(uint);
 
 // uart.c
 void            uartinit(void);
@@ -195,10 +242,22 @@ pde_t*          copyuvm(pde_t*, uint);
 void            switchuvm(struct proc*);
 void            switchkvm(void);
 int             copyout(pde_t*, uint, void*, uint);
+int             copyin(pde_t*, void*, uint, uint);
 void            clearpteu(pde_t *pgdir, char *uva);
+int             ageuvm(pde_t*, uint);
+struct vdsoproc* vdsomap(pde_t*, int);
+extern struct vdso* vdso;
 extern char*    swapsleep;
 extern struct   spinlock swapsleeplock;
 extern int      swapsleepcount;
 
+// zswap.c
+void            zswapinit(void);
+uint            zswap_store(char*);
+int             zswap_ondisk(uint);
+void            zswap_load(uint, char*);
+void            zswap_drop(uint);
+void            zswapdump(void);
+
 // number of elements in fixed-size array
 #define NELEM(x) (sizeof(x)/sizeof((x)[0]))
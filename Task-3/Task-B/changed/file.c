@@ -0,0 +1,301 @@
+//
+// File descriptors
+//
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "fs.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "file.h"
+#include "uio.h"
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+struct devsw devsw[NDEV];
+struct {
+  struct spinlock lock;
+  struct file file[NFILE];
+} ftable;
+
+void
+fileinit(void)
+{
+  initlock(&ftable.lock, "ftable");
+}
+
+// Allocate a file structure.
+struct file*
+filealloc(void)
+{
+  struct file *f;
+
+  acquire(&ftable.lock);
+  for(f = ftable.file; f < ftable.file + NFILE; f++){
+    if(f->ref == 0){
+      f->ref = 1;
+      release(&ftable.lock);
+      return f;
+    }
+  }
+  release(&ftable.lock);
+  return 0;
+}
+
+// Increment ref count for file f.
+struct file*
+filedup(struct file *f)
+{
+  acquire(&ftable.lock);
+  if(f->ref < 1)
+    panic("filedup");
+  f->ref++;
+  release(&ftable.lock);
+  return f;
+}
+
+// Close file f.  (Decrement ref count, close when reaches 0.)
+void
+fileclose(struct file *f)
+{
+  struct file ff;
+
+  acquire(&ftable.lock);
+  if(f->ref < 1)
+    panic("fileclose");
+  if(--f->ref > 0){
+    release(&ftable.lock);
+    return;
+  }
+  ff = *f;
+  f->ref = 0;
+  f->type = FD_NONE;
+  release(&ftable.lock);
+
+  if(ff.type == FD_PIPE)
+    pipeclose(ff.pipe, ff.writable);
+  else if(ff.type == FD_INODE){
+    begin_op();
+    iput(ff.ip);
+    end_op();
+  }
+}
+
+// Get metadata about file f.
+int
+filestat(struct file *f, struct stat *st)
+{
+  if(f->type == FD_INODE){
+    ilock(f->ip);
+    stati(f->ip, st);
+    iunlock(f->ip);
+    return 0;
+  }
+  return -1;
+}
+
+// Read inode file f at *off into the cnt buffers of iov,
+// advancing *off. Stops at the first short read.
+static int
+readiov(struct file *f, struct iovec *iov, int cnt, uint *off)
+{
+  int i, r, tot;
+
+  tot = 0;
+  ilock(f->ip);
+  for(i = 0; i < cnt; i++){
+    if((r = readi(f->ip, iov[i].base, *off, iov[i].len)) < 0){
+      if(tot == 0)
+        tot = -1;
+      break;
+    }
+    *off += r;
+    tot += r;
+    if(r < iov[i].len)
+      break;
+  }
+  iunlock(f->ip);
+  return tot;
+}
+
+// Read from file f.
+int
+fileread(struct file *f, char *addr, int n)
+{
+  struct iovec iov;
+
+  iov.base = addr;
+  iov.len = n;
+  return filereadv(f, &iov, 1);
+}
+
+// Read from file f into several buffers.
+int
+filereadv(struct file *f, struct iovec *iov, int cnt)
+{
+  if(f->readable == 0)
+    return -1;
+  if(f->type == FD_PIPE)
+    return pipereadv(f->pipe, iov, cnt);
+  if(f->type == FD_INODE)
+    return readiov(f, iov, cnt, &f->off);
+  panic("fileread");
+}
+
+// Read from file f at offset off, leaving f->off alone.
+int
+filepread(struct file *f, char *addr, int n, uint off)
+{
+  struct iovec iov;
+
+  if(f->readable == 0 || f->type != FD_INODE)
+    return -1;
+  iov.base = addr;
+  iov.len = n;
+  return readiov(f, &iov, 1, &off);
+}
+
+//PAGEBREAK!
+// Write the cnt buffers of iov to inode file f at *off, advancing
+// *off. Buffers share a log transaction as long as it has room.
+static int
+writeiov(struct file *f, struct iovec *iov, int cnt, uint *off)
+{
+  // write a few blocks at a time to avoid exceeding
+  // the maximum log transaction size, including
+  // i-node, indirect block, allocation blocks,
+  // and 2 blocks of slop for non-aligned writes.
+  // this really belongs lower down, since writei()
+  // might be writing a device like the console.
+  int max = ((MAXOPBLOCKS-1-1-2) / 2) * 512;
+  int i, j, r, n, n1, room, tot, intrans;
+
+  n = 0;
+  for(i = 0; i < cnt; i++)
+    n += iov[i].len;
+
+  tot = 0;
+  room = 0;  // bytes the open transaction can still take
+  intrans = 0;
+  for(i = 0; i < cnt; i++){
+    for(j = 0; j < iov[i].len; j += r){
+      if(room == 0){
+        if(intrans){
+          iunlock(f->ip);
+          end_op();
+        }
+        begin_op();
+        ilock(f->ip);
+        intrans = 1;
+        room = max;
+      }
+      n1 = min(iov[i].len - j, room);
+      if((r = writei(f->ip, (char*)iov[i].base + j, *off, n1)) < 0)
+        goto out;
+      if(r != n1)
+        panic("short filewrite");
+      *off += r;
+      room -= r;
+      tot += r;
+    }
+  }
+
+out:
+  if(intrans){
+    iunlock(f->ip);
+    end_op();
+  }
+  return tot == n ? n : -1;
+}
+
+// Write to file f.
+int
+filewrite(struct file *f, char *addr, int n)
+{
+  struct iovec iov;
+
+  iov.base = addr;
+  iov.len = n;
+  return filewritev(f, &iov, 1);
+}
+
+// Write several buffers to file f.
+int
+filewritev(struct file *f, struct iovec *iov, int cnt)
+{
+  if(f->writable == 0)
+    return -1;
+  if(f->type == FD_PIPE)
+    return pipewritev(f->pipe, iov, cnt);
+  if(f->type == FD_INODE)
+    return writeiov(f, iov, cnt, &f->off);
+  panic("filewrite");
+}
+
+// Write to file f at offset off, leaving f->off alone.
+int
+filepwrite(struct file *f, char *addr, int n, uint off)
+{
+  struct iovec iov;
+
+  if(f->writable == 0 || f->type != FD_INODE)
+    return -1;
+  iov.base = addr;
+  iov.len = n;
+  return writeiov(f, &iov, 1, &off);
+}
+
+// Move up to n bytes from file in to file out, one of them a pipe
+// and the other an inode, without copying through user space: the
+// inode is read or written straight on the pipe's buffer. Returns
+// the number of bytes moved, 0 at end of file, or -1.
+int
+filesplice(struct file *in, struct file *out, int n)
+{
+  int m, r, tot;
+  char *buf;
+
+  if(in->readable == 0 || out->writable == 0)
+    return -1;
+
+  if(in->type == FD_INODE && out->type == FD_PIPE){
+    for(tot = 0; tot < n; tot += r){
+      if((m = pipewbegin(out->pipe, &buf, n - tot)) < 0)
+        return tot > 0 ? tot : -1;
+      ilock(in->ip);
+      if((r = readi(in->ip, buf, in->off, m)) > 0)
+        in->off += r;
+      iunlock(in->ip);
+      pipewend(out->pipe, r > 0 ? r : 0);
+      if(r < 0)
+        return tot > 0 ? tot : -1;
+      if(r < m)  // end of file
+        return tot + r;
+    }
+    return tot;
+  }
+
+  if(in->type == FD_PIPE && out->type == FD_INODE){
+    // Keep each writei() within a log transaction, as filewrite() does.
+    int max = ((MAXOPBLOCKS-1-1-2) / 2) * 512;
+    for(tot = 0; tot < n; tot += r){
+      if((m = piperbegin(in->pipe, &buf, min(n - tot, max))) <= 0)
+        return tot > 0 || m == 0 ? tot : -1;
+      begin_op();
+      ilock(out->ip);
+      if((r = writei(out->ip, buf, out->off, m)) > 0)
+        out->off += r;
+      iunlock(out->ip);
+      end_op();
+      piperend(in->pipe, r > 0 ? r : 0);
+      if(r != m)
+        return tot > 0 ? tot : -1;
+      // Like read(), do not wait for more once the pipe runs dry.
+      if(m < min(n - tot, max))
+        return tot + r;
+    }
+    return tot;
+  }
+  return -1;
+}
@@ -0,0 +1,51 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Times fork()+wait() and fork()+exec()+wait() loops, which are
+// dominated by setupkvm()/copyuvm()/freevm() in the kernel.
+
+int
+main(int argc, char *argv[]){
+
+	int n = 200;
+	char *args[] = { "forkexec", "-", 0 };
+
+	if(argc == 2 && argv[1][0] == '-')
+		exit(); // exec'ed child, nothing to do.
+	if(argc == 2)
+		n = atoi(argv[1]);
+
+	int start = uptime();
+	for(int i=0; i<n; i++){
+		int pid = fork();
+		if(pid < 0){
+			printf(1, "fork failed\n");
+			exit();
+		}
+		if(pid == 0)
+			exit();
+		wait();
+	}
+	int fork_ticks = uptime() - start;
+
+	start = uptime();
+	for(int i=0; i<n; i++){
+		int pid = fork();
+		if(pid < 0){
+			printf(1, "fork failed\n");
+			exit();
+		}
+		if(pid == 0){
+			exec("forkexec", args);
+			printf(1, "exec failed\n");
+			exit();
+		}
+		wait();
+	}
+	int exec_ticks = uptime() - start;
+
+	printf(1, "%d x fork+wait:      %d ticks\n", n, fork_ticks);
+	printf(1, "%d x fork+exec+wait: %d ticks\n", n, exec_ticks);
+	exit();
+}
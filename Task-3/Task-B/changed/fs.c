@@ -0,0 +1,1041 @@
+// File system implementation.  Five layers:
+//   + Blocks: allocator for raw disk blocks.
+//   + Log: crash recovery for multi-step updates.
+//   + Files: inode allocator, reading, writing, metadata.
+//   + Directories: inode with special contents (list of other inodes!)
+//   + Names: paths like /usr/rtm/xv6/fs.c for convenient naming.
+//
+// This file contains the low-level file system manipulation
+// routines.  The (higher-level) system call implementations
+// are in sysfile.c.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "stat.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "buf.h"
+#include "file.h"
+#include "iostat.h"
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+static void itrunc(struct inode*);
+// there should be one superblock per disk device, but we run with
+// only one device
+struct superblock sb;
+
+// Read the super block.
+void
+readsb(int dev, struct superblock *sb)
+{
+  struct buf *bp;
+
+  bp = bread(dev, 1);
+  memmove(sb, bp->data, sizeof(*sb));
+  brelse(bp);
+}
+
+// Zero a block.
+static void
+bzero(int dev, int bno)
+{
+  struct buf *bp;
+
+  bp = bread(dev, bno);
+  memset(bp->data, 0, BSIZE);
+  log_write(bp);
+  brelse(bp);
+}
+
+// Blocks.
+
+// Allocate a zeroed disk block, preferably block near, so that
+// a file written sequentially ends up contiguous on the disk.
+static uint
+balloc(uint dev, uint near)
+{
+  int b, bi, m;
+  struct buf *bp;
+
+  if(near > 0 && near < sb.size){
+    bp = bread(dev, BBLOCK(near, sb));
+    bi = near % BPB;
+    m = 1 << (bi % 8);
+    if((bp->data[bi/8] & m) == 0){
+      bp->data[bi/8] |= m;
+      log_write(bp);
+      brelse(bp);
+      bzero(dev, near);
+      return near;
+    }
+    brelse(bp);
+  }
+
+  bp = 0;
+  for(b = 0; b < sb.size; b += BPB){
+    bp = bread(dev, BBLOCK(b, sb));
+    for(bi = 0; bi < BPB && b + bi < sb.size; bi++){
+      m = 1 << (bi % 8);
+      if((bp->data[bi/8] & m) == 0){  // Is block free?
+        bp->data[bi/8] |= m;  // Mark block in use.
+        log_write(bp);
+        brelse(bp);
+        bzero(dev, b + bi);
+        return b + bi;
+      }
+    }
+    brelse(bp);
+  }
+  panic("balloc: out of blocks");
+}
+
+// Free a disk block.
+static void
+bfree(int dev, uint b)
+{
+  struct buf *bp;
+  int bi, m;
+
+  bp = bread(dev, BBLOCK(b, sb));
+  bi = b % BPB;
+  m = 1 << (bi % 8);
+  if((bp->data[bi/8] & m) == 0)
+    panic("freeing free block");
+  bp->data[bi/8] &= ~m;
+  log_write(bp);
+  brelse(bp);
+}
+
+// Inodes.
+//
+// An inode describes a single unnamed file.
+// The inode disk structure holds metadata: the file's type,
+// its size, the number of links referring to it, and the
+// list of blocks holding the file's content.
+//
+// The inodes are laid out sequentially on disk at
+// sb.startinode. Each inode has a number, indicating its
+// position on the disk.
+//
+// The kernel keeps a cache of in-use inodes in memory
+// to provide a place for synchronizing access
+// to inodes used by multiple processes. The cached
+// inodes include book-keeping information that is
+// not stored on disk: ip->ref and ip->valid.
+//
+// An inode and its in-memory representation go through a
+// sequence of states before they can be used by the
+// rest of the file system code.
+//
+// * Allocation: an inode is allocated if its type (on disk)
+//   is non-zero. ialloc() allocates, and iput() frees if
+//   the reference and link counts have fallen to zero.
+//
+// * Referencing in cache: an entry in the inode cache
+//   is free if ip->ref is zero. Otherwise ip->ref tracks
+//   the number of in-memory pointers to the entry (open
+//   files and current directories). iget() finds or
+//   creates a cache entry and increments its ref; iput()
+//   decrements ref.
+//
+// * Valid: the information (type, size, &c) in an inode
+//   cache entry is only correct when ip->valid is 1.
+//   ilock() reads the inode from
+//   the disk and sets ip->valid, while iput() clears
+//   ip->valid if ip->ref has fallen to zero.
+//
+// * Locked: file system code may only examine and modify
+//   the information in an inode and its content if it
+//   has first locked the inode.
+//
+// Thus a typical sequence is:
+//   ip = iget(dev, inum)
+//   ilock(ip)
+//   ... examine and modify ip->xxx ...
+//   iunlock(ip)
+//   iput(ip)
+//
+// ilock() is separate from iget() so that system calls can
+// get a long-term reference to an inode (as for an open file)
+// and only lock it for short periods (e.g., in read()).
+// The separation also helps avoid deadlock and races during
+// pathname lookup. iget() increments ip->ref so that the inode
+// stays cached and pointers to it remain valid.
+//
+// Many internal file system functions expect the caller to
+// have locked the inodes involved; this lets callers create
+// multi-step atomic operations.
+//
+// The icache.lock spin-lock protects the allocation of icache
+// entries. Since ip->ref indicates whether an entry is free,
+// and ip->dev and ip->inum indicate which i-node an entry
+// holds, one must hold icache.lock while using any of those fields.
+//
+// An ip->lock sleep-lock protects all ip-> fields other than ref,
+// dev, and inum.  One must hold ip->lock in order to
+// read or write that inode's ip->valid, ip->size, ip->type, &c.
+
+struct {
+  struct spinlock lock;
+  struct inode inode[NINODE];
+} icache;
+
+static void dcacheinit(void);
+static void dcacheforget(struct inode*, uint, uint);
+static void dcachepurge(struct inode*);
+
+void
+iinit(int dev)
+{
+  int i = 0;
+
+  initlock(&icache.lock, "icache");
+  dcacheinit();
+  for(i = 0; i < NINODE; i++) {
+    initsleeplock(&icache.inode[i].lock, "inode");
+  }
+
+  readsb(dev, &sb);
+  cprintf("sb: size %d nblocks %d ninodes %d nlog %d logstart %d\
+ inodestart %d bmap start %d\n", sb.size, sb.nblocks,
+          sb.ninodes, sb.nlog, sb.logstart, sb.inodestart,
+          sb.bmapstart);
+}
+
+static struct inode* iget(uint dev, uint inum);
+
+//PAGEBREAK!
+// Allocate an inode on device dev.
+// Mark it as allocated by  giving it type type.
+// Returns an unlocked but allocated and referenced inode,
+// or 0 if the tmpfs has no free tnode.
+struct inode*
+ialloc(uint dev, short type)
+{
+  int inum;
+  struct buf *bp;
+  struct dinode *dip;
+
+  if(dev == TMPDEV){
+    if((inum = tmpfsialloc(type)) == 0)
+      return 0;
+    return iget(dev, inum);
+  }
+
+  for(inum = 1; inum < sb.ninodes; inum++){
+    bp = bread(dev, IBLOCK(inum, sb));
+    dip = (struct dinode*)bp->data + inum%IPB;
+    if(dip->type == 0){  // a free inode
+      memset(dip, 0, sizeof(*dip));
+      dip->type = type;
+      log_write(bp);   // mark it allocated on the disk
+      brelse(bp);
+      return iget(dev, inum);
+    }
+    brelse(bp);
+  }
+  panic("ialloc: no inodes");
+}
+
+// Copy a modified in-memory inode to disk.
+// Must be called after every change to an ip->xxx field
+// that lives on disk, since i-node cache is write-through.
+// Caller must hold ip->lock.
+void
+iupdate(struct inode *ip)
+{
+  struct buf *bp;
+  struct dinode *dip;
+
+  if(ip->dev == TMPDEV){
+    tmpfsiupdate(ip);
+    return;
+  }
+
+  bp = bread(ip->dev, IBLOCK(ip->inum, sb));
+  dip = (struct dinode*)bp->data + ip->inum%IPB;
+  dip->type = ip->type;
+  dip->major = ip->major;
+  dip->minor = ip->minor;
+  dip->nlink = ip->nlink;
+  dip->size = ip->size;
+  memmove(dip->addrs, ip->addrs, sizeof(ip->addrs));
+  log_write(bp);
+  brelse(bp);
+}
+
+// Find the inode with number inum on device dev
+// and return the in-memory copy. Does not lock
+// the inode and does not read it from disk.
+static struct inode*
+iget(uint dev, uint inum)
+{
+  struct inode *ip, *empty;
+
+  acquire(&icache.lock);
+
+  // Is the inode already cached?
+  empty = 0;
+  for(ip = &icache.inode[0]; ip < &icache.inode[NINODE]; ip++){
+    if(ip->ref > 0 && ip->dev == dev && ip->inum == inum){
+      ip->ref++;
+      release(&icache.lock);
+      return ip;
+    }
+    if(empty == 0 && ip->ref == 0)    // Remember empty slot.
+      empty = ip;
+  }
+
+  // Recycle an inode cache entry.
+  if(empty == 0)
+    panic("iget: no inodes");
+
+  ip = empty;
+  ip->dev = dev;
+  ip->inum = inum;
+  ip->ref = 1;
+  ip->valid = 0;
+  ip->raoff = 0;
+  ip->rawin = 0;
+  ip->raend = 0;
+  ip->lastblk = 0;
+  release(&icache.lock);
+
+  return ip;
+}
+
+// Increment reference count for ip.
+// Returns ip to enable ip = idup(ip1) idiom.
+struct inode*
+idup(struct inode *ip)
+{
+  acquire(&icache.lock);
+  ip->ref++;
+  release(&icache.lock);
+  return ip;
+}
+
+// Lock the given inode.
+// Reads the inode from disk if necessary.
+void
+ilock(struct inode *ip)
+{
+  struct buf *bp;
+  struct dinode *dip;
+
+  if(ip == 0 || ip->ref < 1)
+    panic("ilock");
+
+  acquiresleep(&ip->lock);
+
+  if(ip->valid == 0){
+    if(ip->dev == TMPDEV)
+      tmpfsiload(ip);
+    else {
+      bp = bread(ip->dev, IBLOCK(ip->inum, sb));
+      dip = (struct dinode*)bp->data + ip->inum%IPB;
+      ip->type = dip->type;
+      ip->major = dip->major;
+      ip->minor = dip->minor;
+      ip->nlink = dip->nlink;
+      ip->size = dip->size;
+      memmove(ip->addrs, dip->addrs, sizeof(ip->addrs));
+      brelse(bp);
+    }
+    ip->valid = 1;
+    if(ip->type == 0)
+      panic("ilock: no type");
+  }
+}
+
+// Unlock the given inode.
+void
+iunlock(struct inode *ip)
+{
+  if(ip == 0 || !holdingsleep(&ip->lock) || ip->ref < 1)
+    panic("iunlock");
+
+  releasesleep(&ip->lock);
+}
+
+// Drop a reference to an in-memory inode.
+// If that was the last reference, the inode cache entry can
+// be recycled.
+// If that was the last reference and the inode has no links
+// to it, free the inode (and its content) on disk.
+// All calls to iput() must be inside a transaction in
+// case it has to free the inode.
+void
+iput(struct inode *ip)
+{
+  acquiresleep(&ip->lock);
+  if(ip->valid && ip->nlink == 0){
+    acquire(&icache.lock);
+    int r = ip->ref;
+    release(&icache.lock);
+    if(r == 1){
+      // inode has no links and no other references: truncate and free.
+      if(ip->type == T_DIR)
+        dcachepurge(ip);
+      itrunc(ip);
+      ip->type = 0;
+      iupdate(ip);
+      ip->valid = 0;
+    }
+  }
+  releasesleep(&ip->lock);
+
+  acquire(&icache.lock);
+  ip->ref--;
+  release(&icache.lock);
+}
+
+// Common idiom: unlock, then put.
+void
+iunlockput(struct inode *ip)
+{
+  iunlock(ip);
+  iput(ip);
+}
+
+//PAGEBREAK!
+// Inode content
+//
+// The content (data) associated with each inode is stored
+// in blocks on the disk. The first NDIRECT block numbers
+// are listed in ip->addrs[].  The next NINDIRECT blocks are
+// listed in block ip->addrs[NDIRECT]. The remaining NDINDIRECT
+// blocks are listed in indirect blocks, which are themselves
+// listed in the double-indirect block ip->addrs[NDIRECT+1].
+//
+// New blocks are allocated right after the one bmap() returned
+// last when that is free, so sequential files stay contiguous and
+// their reads can be merged by the disk driver.
+
+// Allocate a block for ip, near the one it used last.
+static uint
+bnew(struct inode *ip)
+{
+  return balloc(ip->dev, ip->lastblk ? ip->lastblk + 1 : 0);
+}
+
+// Return entry i of indirect block addr of ip, allocating a block
+// for it if necessary.
+static uint
+bindirect(struct inode *ip, uint addr, uint i)
+{
+  uint *a;
+  struct buf *bp;
+
+  bp = bread(ip->dev, addr);
+  a = (uint*)bp->data;
+  if((addr = a[i]) == 0){
+    a[i] = addr = bnew(ip);
+    log_write(bp);
+  }
+  brelse(bp);
+  return addr;
+}
+
+// Return the disk block address of the nth block in inode ip.
+// If there is no such block, bmap allocates one.
+static uint
+bmap(struct inode *ip, uint bn)
+{
+  uint addr;
+
+  if(bn < NDIRECT){
+    if((addr = ip->addrs[bn]) == 0)
+      ip->addrs[bn] = addr = bnew(ip);
+    return ip->lastblk = addr;
+  }
+  bn -= NDIRECT;
+
+  if(bn < NINDIRECT){
+    // Load indirect block, allocating if necessary.
+    if((addr = ip->addrs[NDIRECT]) == 0)
+      ip->addrs[NDIRECT] = addr = bnew(ip);
+    return ip->lastblk = bindirect(ip, addr, bn);
+  }
+  bn -= NINDIRECT;
+
+  if(bn < NDINDIRECT){
+    // Load the double-indirect block, then the indirect block
+    // it lists, allocating either if necessary.
+    if((addr = ip->addrs[NDIRECT+1]) == 0)
+      ip->addrs[NDIRECT+1] = addr = bnew(ip);
+    addr = bindirect(ip, addr, bn / NINDIRECT);
+    return ip->lastblk = bindirect(ip, addr, bn % NINDIRECT);
+  }
+
+  panic("bmap: out of range");
+}
+
+// Free indirect block addr and the blocks it lists, which are
+// indirect blocks themselves if depth > 1.
+static void
+bfreeind(uint dev, uint addr, int depth)
+{
+  int j;
+  struct buf *bp;
+  uint *a;
+
+  bp = bread(dev, addr);
+  a = (uint*)bp->data;
+  for(j = 0; j < NINDIRECT; j++){
+    if(a[j] == 0)
+      continue;
+    if(depth > 1)
+      bfreeind(dev, a[j], depth - 1);
+    else
+      bfree(dev, a[j]);
+  }
+  brelse(bp);
+  bfree(dev, addr);
+}
+
+// Truncate inode (discard contents).
+// Only called when the inode has no links
+// to it (no directory entries referring to it)
+// and has no in-memory reference to it (is
+// not an open file or current directory).
+static void
+itrunc(struct inode *ip)
+{
+  int i;
+
+  if(ip->dev == TMPDEV){
+    tmpfsitrunc(ip);
+    ip->size = 0;
+    iupdate(ip);
+    return;
+  }
+
+  for(i = 0; i < NDIRECT; i++){
+    if(ip->addrs[i]){
+      bfree(ip->dev, ip->addrs[i]);
+      ip->addrs[i] = 0;
+    }
+  }
+
+  if(ip->addrs[NDIRECT]){
+    bfreeind(ip->dev, ip->addrs[NDIRECT], 1);
+    ip->addrs[NDIRECT] = 0;
+  }
+
+  if(ip->addrs[NDIRECT+1]){
+    bfreeind(ip->dev, ip->addrs[NDIRECT+1], 2);
+    ip->addrs[NDIRECT+1] = 0;
+  }
+
+  ip->size = 0;
+  ip->raend = 0;
+  ip->lastblk = 0;
+  iupdate(ip);
+}
+
+// Copy stat information from inode.
+// Caller must hold ip->lock.
+void
+stati(struct inode *ip, struct stat *st)
+{
+  st->dev = ip->dev;
+  st->ino = ip->inum;
+  st->type = ip->type;
+  st->nlink = ip->nlink;
+  st->size = ip->size;
+}
+
+//PAGEBREAK!
+// Sequential readahead for readi(). A read that starts where the
+// last one ended doubles the inode's readahead window, up to RAMAX
+// blocks; any other read closes it. Start reading the blocks of
+// this request past the first and those in the window after it,
+// so that the disk is busy while readi() copies.
+static void
+readahead(struct inode *ip, uint off, uint n)
+{
+  uint bn, last, end;
+
+  if(off == ip->raoff)
+    ip->rawin = ip->rawin ? min(2*ip->rawin, RAMAX) : 2;
+  else {
+    ip->rawin = 0;
+    ip->raend = 0;
+  }
+  ip->raoff = off + n;
+
+  last = (off + n - 1) / BSIZE;
+  end = min(last + ip->rawin, (ip->size - 1) / BSIZE);
+  bn = off/BSIZE + 1;
+  if(bn < ip->raend)
+    bn = ip->raend;
+  for(; bn <= end; bn++)
+    bprefetch(ip->dev, bmap(ip, bn));
+  if(end + 1 > ip->raend)
+    ip->raend = end + 1;
+}
+
+// Read data from inode.
+// Caller must hold ip->lock.
+int
+readi(struct inode *ip, char *dst, uint off, uint n)
+{
+  uint tot, m;
+  struct buf *bp;
+
+  if(ip->type == T_DEV){
+    if(ip->major < 0 || ip->major >= NDEV || !devsw[ip->major].read)
+      return -1;
+    return devsw[ip->major].read(ip, dst, n);
+  }
+
+  if(off > ip->size || off + n < off)
+    return -1;
+  if(off + n > ip->size)
+    n = ip->size - off;
+  if(ip->dev == TMPDEV)
+    return tmpfsread(ip, dst, off, n);
+  if(n > 0)
+    readahead(ip, off, n);
+
+  for(tot=0; tot<n; tot+=m, off+=m, dst+=m){
+    bp = bread(ip->dev, bmap(ip, off/BSIZE));
+    m = min(n - tot, BSIZE - off%BSIZE);
+    memmove(dst, bp->data + off%BSIZE, m);
+    brelse(bp);
+  }
+  return n;
+}
+
+// PAGEBREAK!
+// Write data to inode.
+// Caller must hold ip->lock.
+int
+writei(struct inode *ip, char *src, uint off, uint n)
+{
+  uint tot, m;
+  struct buf *bp;
+
+  if(ip->type == T_DEV){
+    if(ip->major < 0 || ip->major >= NDEV || !devsw[ip->major].write)
+      return -1;
+    return devsw[ip->major].write(ip, src, n);
+  }
+
+  if(off > ip->size || off + n < off)
+    return -1;
+  if(off + n > MAXFILE*BSIZE)
+    return -1;
+
+  if(ip->type == T_DIR)
+    dcacheforget(ip, off, n);
+
+  if(ip->dev == TMPDEV){
+    if(tmpfswrite(ip, src, off, n) < 0)
+      return -1;
+    off += n;
+  } else {
+    for(tot=0; tot<n; tot+=m, off+=m, src+=m){
+      bp = bread(ip->dev, bmap(ip, off/BSIZE));
+      m = min(n - tot, BSIZE - off%BSIZE);
+      memmove(bp->data + off%BSIZE, src, m);
+      log_write(bp);
+      brelse(bp);
+    }
+  }
+
+  if(n > 0 && off > ip->size){
+    ip->size = off;
+    iupdate(ip);
+  }
+  return n;
+}
+
+//PAGEBREAK!
+// Directories
+
+int
+namecmp(const char *s, const char *t)
+{
+  return strncmp(s, t, DIRSIZ);
+}
+
+// Directory lookup cache.
+//
+// The dcache remembers the outcome of recent dirlookup()s, so that
+// resolving a path does not scan every block of each directory on
+// it. An entry maps (directory, name) to the inode number and offset
+// of the directory entry, or to inode number 0 if the name is not in
+// the directory (a negative entry).
+//
+// Every change to a directory goes through writei(), which forgets
+// the entries at the offsets it overwrites (this is how unlink
+// removes a name), and dirlink() then enters the name it added.
+// iput() forgets a directory's entries when it frees the directory.
+// The caller of all of these holds the directory's lock, so an entry
+// cannot go stale while a lookup uses it. Entries are recycled in
+// clock order.
+
+#define NDHASH 61
+
+struct dentry {
+  uint dev;
+  uint dir;             // inode number of the directory, 0 if unused
+  char name[DIRSIZ];
+  uint inum;            // 0 if name is not in the directory
+  uint off;             // byte offset of the directory entry
+  int used;             // looked up since the clock hand passed
+  struct dentry *next;  // hash chain
+};
+
+struct {
+  struct spinlock lock;
+  struct dentry dentry[NDENTRY];
+  struct dentry *hash[NDHASH];
+  int hand;
+  uint hits;
+  uint negative;
+  uint misses;
+} dcache;
+
+static void
+dcacheinit(void)
+{
+  initlock(&dcache.lock, "dcache");
+}
+
+static struct dentry**
+dhash(uint dev, uint dir, char *name)
+{
+  uint h;
+  int i;
+
+  h = dev*31 + dir;
+  for(i = 0; i < DIRSIZ && name[i]; i++)
+    h = h*31 + name[i];
+  return &dcache.hash[h % NDHASH];
+}
+
+// Find the entry for name in directory dir. Caller holds dcache.lock.
+static struct dentry*
+dfind(uint dev, uint dir, char *name)
+{
+  struct dentry *e;
+
+  for(e = *dhash(dev, dir, name); e; e = e->next)
+    if(e->dev == dev && e->dir == dir && namecmp(e->name, name) == 0)
+      return e;
+  return 0;
+}
+
+// Take e off its hash chain. Caller holds dcache.lock.
+static void
+dunhash(struct dentry *e)
+{
+  struct dentry **pp;
+
+  for(pp = dhash(e->dev, e->dir, e->name); *pp; pp = &(*pp)->next){
+    if(*pp == e){
+      *pp = e->next;
+      break;
+    }
+  }
+  e->dir = 0;
+}
+
+// Remember that name is at offset off in dp, as inode inum,
+// or is not in dp if inum is 0.
+static void
+dcacheenter(struct inode *dp, char *name, uint inum, uint off)
+{
+  struct dentry *e, **pp;
+
+  acquire(&dcache.lock);
+  if((e = dfind(dp->dev, dp->inum, name)) == 0){
+    for(;;){
+      e = &dcache.dentry[dcache.hand];
+      dcache.hand = (dcache.hand + 1) % NDENTRY;
+      if(!e->used)
+        break;
+      e->used = 0;
+    }
+    if(e->dir)
+      dunhash(e);
+    e->dev = dp->dev;
+    e->dir = dp->inum;
+    strncpy(e->name, name, DIRSIZ);
+    pp = dhash(e->dev, e->dir, e->name);
+    e->next = *pp;
+    *pp = e;
+  }
+  e->inum = inum;
+  e->off = off;
+  e->used = 1;
+  release(&dcache.lock);
+}
+
+// Forget the names in the n bytes of dp at off, which are about
+// to be overwritten.
+static void
+dcacheforget(struct inode *dp, uint off, uint n)
+{
+  struct dentry *e;
+
+  acquire(&dcache.lock);
+  for(e = dcache.dentry; e < dcache.dentry+NDENTRY; e++){
+    if(e->dir == dp->inum && e->dev == dp->dev && e->inum != 0 &&
+       e->off + sizeof(struct dirent) > off && e->off < off + n)
+      dunhash(e);
+  }
+  release(&dcache.lock);
+}
+
+// Forget everything about directory dp, which is being freed.
+static void
+dcachepurge(struct inode *dp)
+{
+  struct dentry *e;
+
+  acquire(&dcache.lock);
+  for(e = dcache.dentry; e < dcache.dentry+NDENTRY; e++)
+    if(e->dir == dp->inum && e->dev == dp->dev)
+      dunhash(e);
+  release(&dcache.lock);
+}
+
+// Fill in the directory cache part of st.
+void
+dcachestat(struct iostat *st)
+{
+  acquire(&dcache.lock);
+  st->dhits = dcache.hits;
+  st->dnegative = dcache.negative;
+  st->dmisses = dcache.misses;
+  release(&dcache.lock);
+}
+
+// Look for a directory entry in a directory.
+// If found, set *poff to byte offset of entry.
+struct inode*
+dirlookup(struct inode *dp, char *name, uint *poff)
+{
+  uint off, inum;
+  struct dirent de;
+  struct dentry *e;
+
+  if(dp->type != T_DIR)
+    panic("dirlookup not DIR");
+
+  acquire(&dcache.lock);
+  if((e = dfind(dp->dev, dp->inum, name)) != 0){
+    e->used = 1;
+    inum = e->inum;
+    off = e->off;
+    dcache.hits++;
+    if(inum == 0)
+      dcache.negative++;
+    release(&dcache.lock);
+    if(inum == 0)
+      return 0;
+    if(poff)
+      *poff = off;
+    return iget(dp->dev, inum);
+  }
+  dcache.misses++;
+  release(&dcache.lock);
+
+  for(off = 0; off < dp->size; off += sizeof(de)){
+    if(readi(dp, (char*)&de, off, sizeof(de)) != sizeof(de))
+      panic("dirlookup read");
+    if(de.inum == 0)
+      continue;
+    if(namecmp(name, de.name) == 0){
+      // entry matches path element
+      if(poff)
+        *poff = off;
+      inum = de.inum;
+      dcacheenter(dp, name, inum, off);
+      return iget(dp->dev, inum);
+    }
+  }
+
+  dcacheenter(dp, name, 0, 0);
+  return 0;
+}
+
+// Write a new directory entry (name, inum) into the directory dp.
+int
+dirlink(struct inode *dp, char *name, uint inum)
+{
+  int off;
+  struct dirent de;
+  struct inode *ip;
+
+  // Check that name is not present.
+  if((ip = dirlookup(dp, name, 0)) != 0){
+    iput(ip);
+    return -1;
+  }
+
+  // Look for an empty dirent.
+  for(off = 0; off < dp->size; off += sizeof(de)){
+    if(readi(dp, (char*)&de, off, sizeof(de)) != sizeof(de))
+      panic("dirlink read");
+    if(de.inum == 0)
+      break;
+  }
+
+  strncpy(de.name, name, DIRSIZ);
+  de.inum = inum;
+  if(writei(dp, (char*)&de, off, sizeof(de)) != sizeof(de))
+    panic("dirlink");
+  dcacheenter(dp, name, inum, off);
+
+  return 0;
+}
+
+//PAGEBREAK!
+// Paths
+
+// Copy the next path element from path into name.
+// Return a pointer to the element following the copied one.
+// The returned path has no leading slashes,
+// so the caller can check *path=='\0' to see if the name is the last one.
+// If no name to remove, return 0.
+//
+// Examples:
+//   skipelem("a/bb/c", name) = "bb/c", setting name = "a"
+//   skipelem("///a//bb", name) = "bb", setting name = "a"
+//   skipelem("a", name) = "", setting name = "a"
+//   skipelem("", name) = skipelem("////", name) = 0
+//
+static char*
+skipelem(char *path, char *name)
+{
+  char *s;
+  int len;
+
+  while(*path == '/')
+    path++;
+  if(*path == 0)
+    return 0;
+  s = path;
+  while(*path != '/' && *path != 0)
+    path++;
+  len = path - s;
+  if(len >= DIRSIZ)
+    memmove(name, s, DIRSIZ);
+  else {
+    memmove(name, s, len);
+    name[len] = 0;
+  }
+  while(*path == '/')
+    path++;
+  return path;
+}
+
+// The tmpfs is mounted on directory tmpmnt of the root file system.
+// namex() steps from tmpmnt to tmproot, and back for "..". Both
+// inodes are referenced for good, so they stay in the inode cache.
+static struct inode *tmpmnt;
+static struct inode *tmproot;
+
+// Look up and return the inode for a path name.
+// If parent != 0, return the inode for the parent and copy the final
+// path element into name, which must have room for DIRSIZ bytes.
+// Must be called inside a transaction since it calls iput().
+static struct inode*
+namex(char *path, int nameiparent, char *name)
+{
+  struct inode *ip, *next;
+
+  if(*path == '/')
+    ip = iget(ROOTDEV, ROOTINO);
+  else
+    ip = idup(myproc()->cwd);
+
+  while((path = skipelem(path, name)) != 0){
+    ilock(ip);
+    if(ip->type != T_DIR){
+      iunlockput(ip);
+      return 0;
+    }
+    if(nameiparent && *path == '\0'){
+      // Stop one level early.
+      iunlock(ip);
+      return ip;
+    }
+    if(ip == tmproot && namecmp(name, "..") == 0){
+      // Leave the tmpfs: look up ".." in the mount point.
+      iunlockput(ip);
+      ip = idup(tmpmnt);
+      ilock(ip);
+    }
+    if((next = dirlookup(ip, name, 0)) == 0){
+      iunlockput(ip);
+      return 0;
+    }
+    iunlockput(ip);
+    if(next == tmpmnt && tmpmnt != 0){
+      // Enter the tmpfs.
+      iput(next);
+      next = idup(tmproot);
+    }
+    ip = next;
+  }
+  if(nameiparent){
+    iput(ip);
+    return 0;
+  }
+  return ip;
+}
+
+struct inode*
+namei(char *path)
+{
+  char name[DIRSIZ];
+  return namex(path, 0, name);
+}
+
+struct inode*
+nameiparent(char *path, char *name)
+{
+  return namex(path, 1, name);
+}
+
+// Mount an empty tmpfs on directory path. Called once, from the
+// first process, after the root file system is up.
+void
+tmpmount(char *path)
+{
+  struct inode *dp;
+
+  tmpfsinit();
+  begin_op();
+  if((dp = namei(path)) == 0){
+    end_op();
+    cprintf("tmpmount: no %s\n", path);
+    return;
+  }
+  ilock(dp);
+  if(dp->type != T_DIR){
+    iunlockput(dp);
+    end_op();
+    cprintf("tmpmount: %s not a directory\n", path);
+    return;
+  }
+  iunlock(dp);
+
+  tmproot = iget(TMPDEV, ROOTINO);
+  ilock(tmproot);
+  if(dirlink(tmproot, ".", ROOTINO) < 0 || dirlink(tmproot, "..", ROOTINO) < 0)
+    panic("tmpmount");
+  iunlock(tmproot);
+  tmpmnt = dp;
+  end_op();
+}
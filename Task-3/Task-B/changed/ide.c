@@ -0,0 +1,368 @@
+// IDE driver: bus-master DMA when the PCI IDE controller supports
+// it (the PIIX3 that QEMU emulates does), else multi-sector PIO.
+//
+// Requests are kept in C-SCAN (one-way elevator) order by block
+// number, and runs of queued requests for consecutive blocks in the
+// same direction are merged into a single disk command.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "x86.h"
+#include "traps.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "buf.h"
+#include "iostat.h"
+
+#define SECTOR_SIZE   512
+#define IDE_BSY       0x80
+#define IDE_DRDY      0x40
+#define IDE_DF        0x20
+#define IDE_ERR       0x01
+
+#define IDE_CMD_READ  0x20
+#define IDE_CMD_WRITE 0x30
+#define IDE_CMD_RDMUL 0xc4
+#define IDE_CMD_WRMUL 0xc5
+#define IDE_CMD_SETMUL 0xc6
+#define IDE_CMD_RDDMA 0xc8
+#define IDE_CMD_WRDMA 0xca
+
+// Bus-master registers, relative to the base in PCI BAR4.
+#define BM_CMD        0
+#define BM_STATUS     2
+#define BM_PRDT       4
+#define BM_CMD_START  0x01
+#define BM_CMD_READ   0x08  // device to memory
+#define BM_ST_ERR     0x02
+#define BM_ST_INTR    0x04
+
+#define IDE_MAXMERGE  32    // max blocks per DMA command
+#define IDE_MULT      16    // sectors per PIO interrupt (READ/WRITE MULTIPLE)
+
+// Physical region descriptor: one piece of a DMA transfer. A piece
+// must not cross a 64KB boundary.
+struct prd {
+  uint addr;
+  ushort len;
+  ushort flags;       // 0x8000: last piece
+};
+
+// idequeue points to the buf now being read/written to the disk.
+// idequeue->qnext points to the next buf to be processed.
+// You must hold idelock while manipulating queue.
+
+static struct spinlock idelock;
+static struct buf *idequeue;
+static int idebusy;     // bufs at the head of idequeue being transferred
+static uint idepos;     // block after the last one started, for C-SCAN
+
+static int havedisk1;
+static int idebm;       // bus-master register base, 0 if no DMA
+static int idemult;     // sectors per PIO interrupt
+static struct prd prdt[2*IDE_MAXMERGE] __attribute__((aligned(512)));
+static uint idereqs, ideblocks;
+
+static void idestart(void);
+
+// Wait for IDE disk to become ready.
+static int
+idewait(int checkerr)
+{
+  int r;
+
+  while(((r = inb(0x1f7)) & (IDE_BSY|IDE_DRDY)) != IDE_DRDY)
+    ;
+  if(checkerr && (r & (IDE_DF|IDE_ERR)) != 0)
+    return -1;
+  return 0;
+}
+
+static uint
+pciread(int dev, int func, int reg)
+{
+  outl(0xcf8, 0x80000000 | (dev<<11) | (func<<8) | reg);
+  return inl(0xcfc);
+}
+
+static void
+pciwrite(int dev, int func, int reg, uint v)
+{
+  outl(0xcf8, 0x80000000 | (dev<<11) | (func<<8) | reg);
+  outl(0xcfc, v);
+}
+
+// Look on PCI bus 0 for a bus-master capable IDE controller, enable
+// it as a bus master, and return the I/O base of its bus-master
+// registers, or 0 if there is none.
+static int
+idefindbm(void)
+{
+  int dev, func;
+  uint class, bar;
+
+  for(dev = 0; dev < 32; dev++){
+    for(func = 0; func < 8; func++){
+      if((pciread(dev, func, 0x00) & 0xffff) == 0xffff)
+        continue;
+      class = pciread(dev, func, 0x08);
+      if((class >> 16) != 0x0101 || (class & 0x8000) == 0)
+        continue;
+      bar = pciread(dev, func, 0x20);
+      if((bar & 1) == 0)
+        continue;
+      // I/O space and bus master enable.
+      pciwrite(dev, func, 0x04, pciread(dev, func, 0x04) | 0x5);
+      return bar & 0xfffc;
+    }
+  }
+  return 0;
+}
+
+// Have disk d interrupt once per IDE_MULT sectors in PIO mode.
+static int
+idesetmult(int d)
+{
+  outb(0x1f6, 0xe0 | (d<<4));
+  idewait(0);
+  outb(0x1f2, IDE_MULT);
+  outb(0x1f7, IDE_CMD_SETMUL);
+  return idewait(1);
+}
+
+void
+ideinit(void)
+{
+  int i;
+
+  initlock(&idelock, "ide");
+  ioapicenable(IRQ_IDE, ncpu - 1);
+  idewait(0);
+
+  // Check if disk 1 is present
+  outb(0x1f6, 0xe0 | (1<<4));
+  for(i=0; i<1000; i++){
+    if(inb(0x1f7) != 0){
+      havedisk1 = 1;
+      break;
+    }
+  }
+
+  // No interrupts for the setup commands; idestart() turns them on.
+  outb(0x3f6, 2);
+  idemult = IDE_MULT;
+  if(idesetmult(0) < 0 || (havedisk1 && idesetmult(1) < 0))
+    idemult = 1;
+  idebm = idefindbm();
+  cprintf("ide: %s, %d sectors per PIO interrupt\n",
+          idebm ? "bus-master DMA" : "PIO", idemult);
+
+  // Switch back to disk 0.
+  outb(0x1f6, 0xe0 | (0<<4));
+}
+
+// Start the request at the head of the queue, merged with the queued
+// requests for the blocks that follow it. Caller must hold idelock.
+static void
+idestart(void)
+{
+  struct buf *b, *n;
+  int i, max, nprd;
+  uint pa, len;
+
+  b = idequeue;
+  if(b == 0)
+    panic("idestart");
+  if(BSIZE != SECTOR_SIZE)
+    panic("idestart");
+
+  max = idebm ? IDE_MAXMERGE : idemult;
+  idebusy = 1;
+  for(n = b; n->qnext && idebusy < max; n = n->qnext, idebusy++){
+    if(n->qnext->dev != b->dev || n->qnext->blockno != n->blockno + 1 ||
+       (n->qnext->flags & B_DIRTY) != (b->flags & B_DIRTY))
+      break;
+  }
+  for(i = 0, n = b; i < idebusy; i++, n = n->qnext)
+    if(n->blockno >= FSSIZE)
+      panic("incorrect blockno");
+  idepos = b->blockno + idebusy;
+  idereqs++;
+  ideblocks += idebusy;
+
+  if(idebm){
+    nprd = 0;
+    for(i = 0, n = b; i < idebusy; i++, n = n->qnext){
+      pa = V2P(n->data);
+      len = BSIZE;
+      if((pa & 0xffff) + len > 0x10000){
+        prdt[nprd].addr = pa;
+        prdt[nprd].len = 0x10000 - (pa & 0xffff);
+        prdt[nprd++].flags = 0;
+        len -= 0x10000 - (pa & 0xffff);
+        pa = (pa + 0x10000) & ~0xffff;
+      }
+      prdt[nprd].addr = pa;
+      prdt[nprd].len = len;
+      prdt[nprd++].flags = 0;
+    }
+    prdt[nprd-1].flags = 0x8000;
+    outl(idebm + BM_PRDT, V2P(prdt));
+    outb(idebm + BM_STATUS, BM_ST_ERR | BM_ST_INTR);  // write 1 to clear
+    outb(idebm + BM_CMD, (b->flags & B_DIRTY) ? 0 : BM_CMD_READ);
+  }
+
+  idewait(0);
+  outb(0x3f6, 0);  // generate interrupt
+  outb(0x1f2, idebusy);  // number of sectors
+  outb(0x1f3, b->blockno & 0xff);
+  outb(0x1f4, (b->blockno >> 8) & 0xff);
+  outb(0x1f5, (b->blockno >> 16) & 0xff);
+  outb(0x1f6, 0xe0 | ((b->dev&1)<<4) | ((b->blockno>>24)&0x0f));
+  if(idebm){
+    outb(0x1f7, (b->flags & B_DIRTY) ? IDE_CMD_WRDMA : IDE_CMD_RDDMA);
+    outb(idebm + BM_CMD, inb(idebm + BM_CMD) | BM_CMD_START);
+  } else if(b->flags & B_DIRTY){
+    outb(0x1f7, idemult > 1 ? IDE_CMD_WRMUL : IDE_CMD_WRITE);
+    for(i = 0, n = b; i < idebusy; i++, n = n->qnext)
+      outsl(0x1f0, n->data, BSIZE/4);
+  } else {
+    outb(0x1f7, idemult > 1 ? IDE_CMD_RDMUL : IDE_CMD_READ);
+  }
+}
+
+// Interrupt handler.
+void
+ideintr(void)
+{
+  struct buf *b, *async[IDE_MAXMERGE];
+  int i, nasync, st;
+
+  // The first idebusy queued buffers are the active request.
+  acquire(&idelock);
+
+  if(idequeue == 0 || idebusy == 0){
+    release(&idelock);
+    return;
+  }
+  if(idebm){
+    st = inb(idebm + BM_STATUS);
+    if((st & BM_ST_INTR) == 0){
+      // Not the end of our transfer.
+      release(&idelock);
+      return;
+    }
+    outb(idebm + BM_CMD, inb(idebm + BM_CMD) & ~BM_CMD_START);
+    outb(idebm + BM_STATUS, BM_ST_ERR | BM_ST_INTR);
+    idewait(0);  // reading the status acknowledges the interrupt
+  } else if(!(idequeue->flags & B_DIRTY) && idewait(1) >= 0){
+    // Read data if needed.
+    for(i = 0, b = idequeue; i < idebusy; i++, b = b->qnext)
+      insl(0x1f0, b->data, BSIZE/4);
+  }
+
+  // Wake processes waiting for these bufs. Once they run, the bufs
+  // may be reused, so decide now which ones we have to release.
+  nasync = 0;
+  for(i = 0; i < idebusy; i++){
+    b = idequeue;
+    idequeue = b->qnext;
+    if(b->flags & B_ASYNC)
+      async[nasync++] = b;
+    b->flags |= B_VALID;
+    b->flags &= ~B_DIRTY;
+    wakeup(b);
+  }
+  idebusy = 0;
+
+  // Start disk on next buf in queue.
+  if(idequeue != 0)
+    idestart();
+
+  release(&idelock);
+
+  // Nobody waits for a readahead buffer; let go of it.
+  for(i = 0; i < nasync; i++)
+    bdone(async[i]);
+}
+
+// Position of b in C-SCAN order: blocks at or after the disk head
+// first, in increasing order, then the ones behind it.
+static uint
+idekey(struct buf *b)
+{
+  return b->blockno >= idepos ? b->blockno - idepos : b->blockno + FSSIZE;
+}
+
+//PAGEBREAK!
+// Queue buf for the disk like iderw(), but do not wait for it,
+// so that several requests can be outstanding. Use idecomplete()
+// to wait, unless B_ASYNC is set.
+void
+idesubmit(struct buf *b)
+{
+  struct buf **pp;
+  int i;
+
+  if(!holdingsleep(&b->lock))
+    panic("iderw: buf not locked");
+  if((b->flags & (B_VALID|B_DIRTY)) == B_VALID)
+    panic("iderw: nothing to do");
+  if(b->dev != 0 && !havedisk1)
+    panic("iderw: ide disk 1 not present");
+
+  acquire(&idelock);  //DOC:acquire-lock
+
+  // Insert b into idequeue in elevator order, behind the request
+  // being transferred.
+  pp = &idequeue;
+  for(i = 0; i < idebusy; i++)
+    pp = &(*pp)->qnext;
+  while(*pp && idekey(*pp) <= idekey(b))  //DOC:insert-queue
+    pp = &(*pp)->qnext;
+  b->qnext = *pp;
+  *pp = b;
+
+  // Start disk if necessary.
+  if(idebusy == 0)
+    idestart();
+
+  release(&idelock);
+}
+
+// Wait for a request queued by idesubmit() to finish.
+void
+idecomplete(struct buf *b)
+{
+  acquire(&idelock);
+  while((b->flags & (B_VALID|B_DIRTY)) != B_VALID){
+    sleep(b, &idelock);
+  }
+  release(&idelock);
+}
+
+// Sync buf with disk.
+// If B_DIRTY is set, write buf to disk, clear B_DIRTY, set B_VALID.
+// Else if B_VALID is not set, read buf from disk, set B_VALID.
+void
+iderw(struct buf *b)
+{
+  idesubmit(b);
+  idecomplete(b);
+}
+
+// Fill in the disk part of st.
+void
+idestat(struct iostat *st)
+{
+  acquire(&idelock);
+  st->idma = idebm != 0;
+  st->ireqs = idereqs;
+  st->iblocks = ideblocks;
+  release(&idelock);
+}
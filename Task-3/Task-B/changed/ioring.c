@@ -0,0 +1,316 @@
+// Asynchronous I/O rings (see ioring.h).
+//
+// ioringenter() runs in the submitting process: it takes the new
+// submission queue entries, checks them and queues them, with a
+// reference to the file, for the IORING kernel process. That
+// process does the reads and writes one at a time through a
+// bounce page, copying to and from the submitter's memory with
+// its page table, and posts each result on the completion queue.
+// So a process can have many requests done for one system call
+// trap, and need not trap at all to collect the results.
+//
+// Only inode files can be used, and not devices, whose reads may
+// wait forever. Buffers must be resident: a request on a page
+// that has been swapped out fails with -1.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "fs.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "file.h"
+#include "stat.h"
+#include "ioring.h"
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+#define NIOREQ 64  // requests queued for IORING, over all processes
+
+int mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm);
+
+// A process's ring.
+struct ioctx {
+  struct proc *proc;    // owner, or 0 if the slot is free
+  pde_t *pgdir;         // owner's page table when the ring was set up
+  struct ioring *ring;  // kernel address of the ring page
+  int inflight;         // requests queued or being done
+};
+
+struct ioreq {
+  struct ioctx *ctx;
+  struct file *f;
+  struct io_sqe sqe;
+  struct ioreq *next;
+};
+
+struct {
+  struct spinlock lock;
+  struct ioctx ctx[NPROC];
+  struct ioreq req[NIOREQ];
+  struct ioreq *free;
+  struct ioreq *head;   // queue for IORING
+  struct ioreq *tail;
+} iorings;
+
+void
+ioringinit(void)
+{
+  struct ioreq *q;
+
+  initlock(&iorings.lock, "ioring");
+  for(q = iorings.req; q < iorings.req + NIOREQ; q++){
+    q->next = iorings.free;
+    iorings.free = q;
+  }
+}
+
+// Map a ring into the current process at IORINGVA.
+// Returns its address, or -1.
+int
+ioringsetup(void)
+{
+  struct proc *curproc = myproc();
+  struct ioctx *c;
+  char *mem;
+
+  if(curproc->ioctx)
+    return -1;
+  acquire(&iorings.lock);
+  for(c = iorings.ctx; c < iorings.ctx + NPROC; c++)
+    if(c->proc == 0)
+      goto found;
+  release(&iorings.lock);
+  return -1;
+
+found:
+  c->proc = curproc;
+  release(&iorings.lock);
+
+  if((mem = kalloc()) == 0)
+    goto bad;
+  memset(mem, 0, PGSIZE);
+  if(mappages(curproc->pgdir, (char*)IORINGVA, PGSIZE, V2P(mem), PTE_W|PTE_U) < 0){
+    kfree(mem);
+    goto bad;
+  }
+  c->pgdir = curproc->pgdir;
+  c->ring = (struct ioring*)mem;
+  c->inflight = 0;
+  curproc->ioctx = c;
+  return IORINGVA;
+
+bad:
+  acquire(&iorings.lock);
+  c->proc = 0;
+  release(&iorings.lock);
+  return -1;
+}
+
+// Post a completion. Caller holds iorings.lock, and has made sure
+// there is room by counting the request in c->inflight.
+static void
+ioringpost(struct ioctx *c, uint data, int res)
+{
+  struct io_cqe *e;
+
+  e = &c->ring->cq[c->ring->cqtail % IORING_CQ];
+  e->data = data;
+  e->res = res;
+  c->ring->cqtail++;
+}
+
+// Check submission s of the current process and return a new
+// reference to its file, or 0 if the request is bad.
+static struct file*
+ioringfile(struct io_sqe *s)
+{
+  struct proc *curproc = myproc();
+  struct file *f;
+  uint a;
+  short type;
+
+  if(s->fd < 0 || s->fd >= NOFILE || (f = curproc->ofile[s->fd]) == 0)
+    return 0;
+  if(f->type != FD_INODE)
+    return 0;
+  switch(s->op){
+  case IORING_OP_READ:
+    if(f->readable == 0)
+      return 0;
+    break;
+  case IORING_OP_WRITE:
+    if(f->writable == 0)
+      return 0;
+    break;
+  case IORING_OP_FSYNC:
+    return filedup(f);
+  default:
+    return 0;
+  }
+  a = (uint)s->buf;
+  if(s->len < 0 || s->off < -1 || a > curproc->sz || s->len > curproc->sz - a)
+    return 0;
+  ilock(f->ip);
+  type = f->ip->type;
+  iunlock(f->ip);
+  if(type == T_DEV)
+    return 0;
+  return filedup(f);
+}
+
+// Queue the current process's new submissions for IORING. Then,
+// if wait > 0, sleep until there are at least wait completions to
+// collect or nothing is left in flight. Submissions stay on the
+// queue while the completion queue could not take their results.
+// Returns the number of entries taken, or -1 without a ring.
+int
+ioringenter(int wait)
+{
+  struct proc *curproc = myproc();
+  struct ioctx *c = curproc->ioctx;
+  struct ioring *r;
+  struct ioreq *q;
+  int n;
+
+  if(c == 0)
+    return -1;
+  r = c->ring;
+  acquire(&iorings.lock);
+  for(n = 0; r->sqhead != r->sqtail; n++){
+    if(c->inflight + (r->cqtail - r->cqhead) >= IORING_CQ)
+      break;
+    while((q = iorings.free) == 0)
+      sleep(&iorings.free, &iorings.lock);
+    iorings.free = q->next;
+    q->ctx = c;
+    q->sqe = r->sq[r->sqhead % IORING_SQ];
+    q->next = 0;
+    r->sqhead++;
+    c->inflight++;
+
+    // Checking the file may sleep.
+    release(&iorings.lock);
+    q->f = ioringfile(&q->sqe);
+    acquire(&iorings.lock);
+
+    if(q->f == 0){
+      ioringpost(c, q->sqe.data, -1);
+      c->inflight--;
+      q->next = iorings.free;
+      iorings.free = q;
+      continue;
+    }
+    if(iorings.tail)
+      iorings.tail->next = q;
+    else
+      iorings.head = q;
+    iorings.tail = q;
+  }
+  wakeup(&iorings.head);
+
+  while(wait > 0 && c->inflight > 0 && r->cqtail - r->cqhead < wait){
+    if(curproc->killed)
+      break;
+    sleep(c, &iorings.lock);
+  }
+  release(&iorings.lock);
+  return n;
+}
+
+// Do request q, using bounce as a page of scratch.
+// Returns the result for its completion.
+static int
+ioringdo(struct ioreq *q, char *bounce)
+{
+  struct io_sqe *s = &q->sqe;
+  pde_t *pgdir = q->ctx->pgdir;
+  uint va = (uint)s->buf;
+  int n, r, tot;
+
+  if(s->op == IORING_OP_FSYNC){
+    logsync();
+    return 0;
+  }
+
+  for(tot = 0; tot < s->len; tot += r){
+    n = min(s->len - tot, PGSIZE);
+    if(s->op == IORING_OP_READ){
+      if(s->off < 0)
+        r = fileread(q->f, bounce, n);
+      else
+        r = filepread(q->f, bounce, n, s->off + tot);
+      if(r > 0 && copyout(pgdir, va + tot, bounce, r) < 0)
+        r = -1;
+    } else {
+      if(copyin(pgdir, bounce, va + tot, n) < 0)
+        r = -1;
+      else if(s->off < 0)
+        r = filewrite(q->f, bounce, n);
+      else
+        r = filepwrite(q->f, bounce, n, s->off + tot);
+    }
+    if(r < 0)
+      return tot > 0 ? tot : -1;
+    if(r < n)
+      return tot + r;
+  }
+  return tot;
+}
+
+// Kernel process that does the queued requests.
+void
+IORING_PROCESS(void)
+{
+  struct ioreq *q;
+  struct ioctx *c;
+  struct file *f;
+  char *bounce;
+  int res;
+
+  if((bounce = kalloc()) == 0)
+    panic("IORING_PROCESS");
+  for(;;){
+    acquire(&iorings.lock);
+    while((q = iorings.head) == 0)
+      sleep(&iorings.head, &iorings.lock);
+    if((iorings.head = q->next) == 0)
+      iorings.tail = 0;
+    release(&iorings.lock);
+
+    res = ioringdo(q, bounce);
+
+    acquire(&iorings.lock);
+    c = q->ctx;
+    f = q->f;
+    ioringpost(c, q->sqe.data, res);
+    c->inflight--;
+    wakeup(c);
+    q->next = iorings.free;
+    iorings.free = q;
+    wakeup(&iorings.free);
+    release(&iorings.lock);
+
+    fileclose(f);
+  }
+}
+
+// Give up p's ring, once its requests are done, as p's memory is
+// about to go away. The ring page goes with the page table.
+void
+ioringfree(struct proc *p)
+{
+  struct ioctx *c = p->ioctx;
+
+  if(c == 0)
+    return;
+  acquire(&iorings.lock);
+  while(c->inflight > 0)
+    sleep(c, &iorings.lock);
+  c->proc = 0;
+  release(&iorings.lock);
+  p->ioctx = 0;
+}
@@ -0,0 +1,39 @@
+// Asynchronous I/O ring, shared between a process and the kernel.
+//
+// ioring_setup() maps one page holding a struct ioring into the
+// process and returns its address. The process fills in sq entries
+// at sqtail and advances sqtail; ioring_enter() hands the new ones
+// to the kernel's IORING worker, which posts a cq entry at cqtail
+// as each finishes. The process takes completions at cqhead and
+// advances cqhead. Requests may finish in any order; data tells
+// them apart.
+
+#define IORING_SQ   64   // submission queue entries
+#define IORING_CQ  128   // completion queue entries
+
+#define IORING_OP_READ   1
+#define IORING_OP_WRITE  2
+#define IORING_OP_FSYNC  3   // wait until earlier writes are committed
+
+struct io_sqe {
+  int op;
+  int fd;
+  void *buf;
+  int len;
+  int off;      // file offset, or -1 to use and advance the fd's
+  uint data;    // copied to the completion
+};
+
+struct io_cqe {
+  uint data;
+  int res;      // as returned by the corresponding system call
+};
+
+struct ioring {
+  uint sqhead;  // next entry the kernel takes
+  uint sqtail;  // next entry the process fills in
+  uint cqhead;  // next completion the process takes
+  uint cqtail;  // next completion the kernel fills in
+  struct io_sqe sq[IORING_SQ];
+  struct io_cqe cq[IORING_CQ];
+};
@@ -0,0 +1,38 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "iostat.h"
+
+// Print the kernel's I/O statistics.
+
+int
+main(int argc, char *argv[]){
+
+	struct iostat st;
+	int t;
+
+	if(iostat(&st) < 0){
+		printf(2, "iostat: failed\n");
+		exit();
+	}
+	printf(1, "bcache: %d buffers, %d hits, %d misses, %d evictions, %d read ahead\n",
+		st.nbuf, st.bhits, st.bmisses, st.bevictions, st.breadahead);
+	printf(1, "dcache: %d hits (%d negative), %d misses\n",
+		st.dhits, st.dnegative, st.dmisses);
+	printf(1, "disk: %s, %d commands, %d blocks", st.idma ? "dma" : "pio",
+		st.ireqs, st.iblocks);
+	if(st.ireqs > 0)
+		printf(1, " (%d.%d per command)", st.iblocks / st.ireqs,
+			(st.iblocks * 10 / st.ireqs) % 10);
+	printf(1, "\n");
+	t = uptime();
+	printf(1, "log: %d blocks, %d commits", st.lsize, st.lcommits);
+	if(t >= 100)
+		printf(1, " (%d per second)", st.lcommits / (t / 100));
+	printf(1, ", %d blocks, %d system calls", st.lblocks, st.lops);
+	if(st.lcommits > 0)
+		printf(1, " (%d and %d per commit)", st.lblocks / st.lcommits,
+			st.lops / st.lcommits);
+	printf(1, "\n");
+	exit();
+}
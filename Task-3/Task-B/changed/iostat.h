@@ -0,0 +1,22 @@
+// I/O statistics, returned by the iostat system call.
+struct iostat {
+  // Block cache (bio.c)
+  uint nbuf;        // buffers in the cache
+  uint bhits;       // lookups that found the block cached
+  uint bmisses;     // lookups that had to recycle a buffer
+  uint bevictions;  // misses that threw a cached block out
+  uint breadahead;  // blocks read ahead of readi()
+  // Directory lookup cache (fs.c)
+  uint dhits;       // dirlookup()s answered from the cache
+  uint dnegative;   // of which found the name absent
+  uint dmisses;     // dirlookup()s that scanned the directory
+  // Disk (ide.c)
+  uint idma;        // using bus-master DMA?
+  uint ireqs;       // disk commands issued
+  uint iblocks;     // blocks transferred by them
+  // Log (log.c)
+  uint lsize;       // max blocks per commit
+  uint lcommits;    // commits
+  uint lblocks;     // blocks committed
+  uint lops;        // FS system calls committed
+};
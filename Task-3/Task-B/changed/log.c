@@ -0,0 +1,329 @@
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "buf.h"
+#include "iostat.h"
+
+// Simple logging that allows concurrent FS system calls.
+//
+// A log transaction contains the updates of multiple FS system
+// calls. The logging system only commits when there are
+// no FS system calls active. Thus there is never
+// any reasoning required about whether a commit might
+// write an uncommitted system call's updates to disk.
+//
+// A system call should call begin_op()/end_op() to mark
+// its start and end. Usually begin_op() just increments
+// the count of in-progress FS system calls and returns.
+// But if it thinks the log is close to running out, it
+// sleeps until the log has been committed.
+//
+// Commits are grouped: end_op() does not commit by itself. The
+// LOG_COMMIT kernel process commits once no FS system call is
+// active and the transaction is LOGDELAY ticks old, or sooner if
+// the log is about to fill up. So a commit usually holds many
+// system calls, which return without waiting for the disk; a crash
+// loses at most the last LOGDELAY ticks of updates, never part of
+// a system call. LOG_COMMIT also does the checkpoint (installing
+// the blocks at their home locations), off the system call path.
+//
+// The log is a physical re-do log containing disk blocks.
+// The on-disk log format:
+//   header block, containing block #s for block A, B, C, ...
+//   block A
+//   block B
+//   block C
+//   ...
+// Log appends are synchronous.
+
+// Contents of the header block, used for both the on-disk header block
+// and to keep track in memory of logged block# before commit.
+struct logheader {
+  int n;
+  int block[LOGSIZE];
+};
+
+struct log {
+  struct spinlock lock;
+  int start;
+  int size;
+  int outstanding; // how many FS sys calls are executing.
+  int committing;  // in commit(), please wait.
+  int wantcommit;  // log is (nearly) full, commit as soon as possible.
+  uint since;      // ticks when the first op of the transaction ended
+  int nops;        // FS sys calls in the transaction
+  uint ndone;      // commits finished, for logsync()
+  int dev;
+  struct logheader lh;
+  uint ncommits;   // statistics for iostat
+  uint nblocks;
+  uint nopsdone;
+};
+struct log log;
+
+static void recover_from_log(void);
+static void commit();
+
+void
+initlog(int dev)
+{
+  if (sizeof(struct logheader) >= BSIZE)
+    panic("initlog: too big logheader");
+
+  struct superblock sb;
+  initlock(&log.lock, "log");
+  readsb(dev, &sb);
+  log.start = sb.logstart;
+  log.size = sb.nlog;
+  log.dev = dev;
+  recover_from_log();
+}
+
+// Copy committed blocks from log to their home location.
+// All the writes are queued to the disk before waiting for any.
+static void
+install_trans(void)
+{
+  int tail;
+  struct buf *dbuf[LOGSIZE];
+
+  for (tail = 0; tail < log.lh.n; tail++) {
+    struct buf *lbuf = bread(log.dev, log.start+tail+1); // read log block
+    dbuf[tail] = bread(log.dev, log.lh.block[tail]); // read dst
+    memmove(dbuf[tail]->data, lbuf->data, BSIZE);  // copy block to dst
+    bwritestart(dbuf[tail]);  // start writing dst to disk
+    brelse(lbuf);
+  }
+  for (tail = 0; tail < log.lh.n; tail++) {
+    bwait(dbuf[tail]);
+    brelse(dbuf[tail]);
+  }
+}
+
+// Read the log header from disk into the in-memory log header
+static void
+read_head(void)
+{
+  struct buf *buf = bread(log.dev, log.start);
+  struct logheader *lh = (struct logheader *) (buf->data);
+  int i;
+  log.lh.n = lh->n;
+  for (i = 0; i < log.lh.n; i++) {
+    log.lh.block[i] = lh->block[i];
+  }
+  brelse(buf);
+}
+
+// Write in-memory log header to disk.
+// This is the true point at which the
+// current transaction commits.
+static void
+write_head(void)
+{
+  struct buf *buf = bread(log.dev, log.start);
+  struct logheader *hb = (struct logheader *) (buf->data);
+  int i;
+  hb->n = log.lh.n;
+  for (i = 0; i < log.lh.n; i++) {
+    hb->block[i] = log.lh.block[i];
+  }
+  bwrite(buf);
+  brelse(buf);
+}
+
+static void
+recover_from_log(void)
+{
+  read_head();
+  install_trans(); // if committed, copy from log to disk
+  log.lh.n = 0;
+  write_head(); // clear the log
+}
+
+// called at the start of each FS system call.
+void
+begin_op(void)
+{
+  acquire(&log.lock);
+  while(1){
+    if(log.committing){
+      sleep(&log, &log.lock);
+    } else if(log.lh.n + (log.outstanding+1)*MAXOPBLOCKS > LOGSIZE){
+      // this op might exhaust log space; wait for commit.
+      log.wantcommit = 1;
+      wakeup(&log);
+      sleep(&log, &log.lock);
+    } else {
+      log.outstanding += 1;
+      release(&log.lock);
+      break;
+    }
+  }
+}
+
+// called at the end of each FS system call.
+// lets LOG_COMMIT know if this was the last outstanding operation.
+void
+end_op(void)
+{
+  acquire(&log.lock);
+  log.outstanding -= 1;
+  if(log.committing)
+    panic("log.committing");
+  if(log.lh.n > 0 && log.nops++ == 0)
+    log.since = ticks;
+  if(log.lh.n + MAXOPBLOCKS > LOGSIZE)
+    log.wantcommit = 1;
+  // begin_op() may be waiting for log space,
+  // and decrementing log.outstanding has decreased
+  // the amount of reserved space. LOG_COMMIT may be
+  // waiting for outstanding to drop to 0.
+  wakeup(&log);
+  release(&log.lock);
+}
+
+// Whether LOG_COMMIT should commit now. Caller holds log.lock.
+static int
+commitdue(void)
+{
+  if(log.outstanding > 0 || log.lh.n == 0)
+    return 0;
+  return log.wantcommit || ticks - log.since >= LOGDELAY;
+}
+
+// Kernel process that commits the log (see the top of the file).
+// While a transaction is waiting for its LOGDELAY, poll every tick.
+void
+LOG_COMMIT_PROCESS(void)
+{
+  for(;;){
+    acquire(&log.lock);
+    while(!commitdue()){
+      if(log.lh.n > 0 && log.outstanding == 0){
+        release(&log.lock);
+        acquire(&tickslock);
+        sleep(&ticks, &tickslock);
+        release(&tickslock);
+        acquire(&log.lock);
+      } else
+        sleep(&log, &log.lock);
+    }
+    log.committing = 1;
+    log.ncommits++;
+    log.nblocks += log.lh.n;
+    log.nopsdone += log.nops;
+    log.nops = 0;
+    log.wantcommit = 0;
+    release(&log.lock);
+
+    // call commit w/o holding locks, since not allowed
+    // to sleep with locks.
+    commit();
+
+    acquire(&log.lock);
+    log.committing = 0;
+    log.ndone++;
+    wakeup(&log);
+    release(&log.lock);
+  }
+}
+
+// Wait until the transactions that have ended so far are on disk,
+// asking LOG_COMMIT not to wait out LOGDELAY for them.
+void
+logsync(void)
+{
+  uint target;
+
+  acquire(&log.lock);
+  if(log.committing)
+    target = log.ndone + 1;
+  else if(log.lh.n > 0){
+    target = log.ndone + 1;
+    log.wantcommit = 1;
+    wakeup(&log);
+  } else
+    target = log.ndone;
+  while((int)(log.ndone - target) < 0)
+    sleep(&log, &log.lock);
+  release(&log.lock);
+}
+
+// Fill in the log part of st.
+void
+logstat(struct iostat *st)
+{
+  acquire(&log.lock);
+  st->lsize = LOGSIZE;
+  st->lcommits = log.ncommits;
+  st->lblocks = log.nblocks;
+  st->lops = log.nopsdone;
+  release(&log.lock);
+}
+
+// Copy modified blocks from cache to log.
+// All the writes are queued to the disk before waiting for any.
+static void
+write_log(void)
+{
+  int tail;
+  struct buf *to[LOGSIZE];
+
+  for (tail = 0; tail < log.lh.n; tail++) {
+    to[tail] = bread(log.dev, log.start+tail+1); // log block
+    struct buf *from = bread(log.dev, log.lh.block[tail]); // cache block
+    memmove(to[tail]->data, from->data, BSIZE);
+    bwritestart(to[tail]);  // start writing the log
+    brelse(from);
+  }
+  for (tail = 0; tail < log.lh.n; tail++) {
+    bwait(to[tail]);
+    brelse(to[tail]);
+  }
+}
+
+static void
+commit()
+{
+  if (log.lh.n > 0) {
+    write_log();     // Write modified blocks from cache to log
+    write_head();    // Write header to disk -- the real commit
+    install_trans(); // Now install writes to home locations
+    log.lh.n = 0;
+    write_head();    // Erase the transaction from the log
+  }
+}
+
+// Caller has modified b->data and is done with the buffer.
+// Record the block number and pin in the cache with B_DIRTY.
+// commit()/write_log() will do the disk write.
+//
+// log_write() replaces bwrite(); a typical use is:
+//   bp = bread(...)
+//   modify bp->data[]
+//   log_write(bp)
+//   brelse(bp)
+void
+log_write(struct buf *b)
+{
+  int i;
+
+  if (log.lh.n >= LOGSIZE || log.lh.n >= log.size - 1)
+    panic("too big a transaction");
+  if (log.outstanding < 1)
+    panic("log_write outside of trans");
+
+  acquire(&log.lock);
+  for (i = 0; i < log.lh.n; i++) {
+    if (log.lh.block[i] == b->blockno)   // log absorbtion
+      break;
+  }
+  log.lh.block[i] = b->blockno;
+  if (i == log.lh.n)
+    log.lh.n++;
+  b->flags |= B_DIRTY; // prevent eviction
+  release(&log.lock);
+}
@@ -9,6 +9,8 @@
 // Key addresses for address space layout (see kmap in vm.c for layout)
 #define KERNBASE 0x80000000         // First kernel virtual address
 #define KERNLINK (KERNBASE+EXTMEM)  // Address where kernel is linked
+#define IORINGVA (KERNBASE-PGSIZE)  // User address of the I/O ring (see ioring.c)
+// VDSOPROC, below IORINGVA, and VDSO, below DEVSPACE, are in vdso.h.
 
 #define V2P(a) (((uint) (a)) - KERNBASE)
 #define P2V(a) ((void *)(((char *) (a)) + KERNBASE))
@@ -10,6 +10,12 @@
 #define CR0_PG          0x80000000      // Paging
 
 #define CR4_PSE         0x00000010      // Page size extension
+#define CR4_PGE         0x00000080      // Page global enable
+
+// Model-specific registers for sysenter
+#define MSR_SYSENTER_CS  0x174          // kernel %cs; %ss is the next
+#define MSR_SYSENTER_ESP 0x175          // kernel %esp
+#define MSR_SYSENTER_EIP 0x176          // kernel entry point
 
 // various segment selectors.
 #define SEG_KCODE 1  // kernel code
@@ -95,7 +101,23 @@ struct segdesc {
 #define PTE_W           0x002   // Writeable
 #define PTE_U           0x004   // User
 #define PTE_A           0x020   // Accessed
+#define PTE_D           0x040   // Dirty
 #define PTE_PS          0x080   // Page Size
+#define PTE_G           0x100   // Global (survives %cr3 loads)
+
+// Page age, kept by the page-aging process in the PTE bits the
+// hardware leaves to software: aging passes since the page was
+// last referenced, up to PTE_MAXAGE.
+#define PTE_AGESHIFT    9
+#define PTE_AGEMASK     0xE00
+#define PTE_MAXAGE      7
+#define PTE_AGE(pte)    (((uint)(pte) & PTE_AGEMASK) >> PTE_AGESHIFT)
+
+// Where the page of a swapped-out (0x080) PTE is, see zswap.c: nowhere
+// if it was all zeroes, else in the zswap pool if the address bits
+// hold a handle, else in its swap file.
+#define PTE_ZERO        0x040
+#define PTE_ZSLOT(pte)  ((uint)(pte) >> PTXSHIFT)
 
 // Address in page table or page directory entry
 #define PTE_ADDR(pte)   ((uint)(pte) & ~0xFFF)
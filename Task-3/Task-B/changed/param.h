@@ -4,11 +4,22 @@
 #define NOFILE       16  // open files per process
 #define NFILE       100  // open files per system
 #define NINODE       50  // maximum number of active i-nodes
+#define NDENTRY     256  // directory lookup cache entries
 #define NDEV         10  // maximum major device number
 #define ROOTDEV       1  // device number of file system root disk
+#define TMPDEV        2  // device number of the tmpfs on /tmp
+#define NTNODE      100  // files in the tmpfs
+#define TMPPAGES    512  // max pages the tmpfs may hold
 #define MAXARG       32  // max exec arguments
 #define MAXOPBLOCKS  10  // max # of blocks any FS op writes
-#define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
-#define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
-#define FSSIZE       1000  // size of file system in blocks
+#define LOGSIZE      (MAXOPBLOCKS*6)  // max data blocks in on-disk log (< 127)
+#define LOGDELAY        5  // ticks a transaction may wait to be committed
+#define NBUF         (LOGSIZE*3)  // min size of disk block cache
+#define BCACHEDIV      64  // disk block cache gets 1/BCACHEDIV of memory
+#define RAMAX          16  // max sequential readahead window, in blocks
+#define FSSIZE       20000  // size of file system in blocks
+#define AGETICKS      100  // ticks between page-aging passes
+#define WSWINDOW        2  // aging passes a page stays in the working set
+#define SWAPBATCH       4  // max pages evicted per swap-out request
+#define ZPOOLPAGES    128  // max pages of compressed swapped-out pages
 
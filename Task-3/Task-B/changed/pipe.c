@@ -0,0 +1,257 @@
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "fs.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "file.h"
+#include "uio.h"
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+
+// The data lives in a page of its own, and readers and writers copy
+// whole runs of it at a time rather than one byte per loop.
+#define PIPESIZE PGSIZE
+
+struct pipe {
+  struct spinlock lock;
+  char *data;
+  uint nread;     // number of bytes read
+  uint nwrite;    // number of bytes written
+  int readopen;   // read fd is still open
+  int writeopen;  // write fd is still open
+  int rbusy;      // a splice is copying out of data
+  int wbusy;      // a splice is copying into data
+};
+
+int
+pipealloc(struct file **f0, struct file **f1)
+{
+  struct pipe *p;
+
+  p = 0;
+  *f0 = *f1 = 0;
+  if((*f0 = filealloc()) == 0 || (*f1 = filealloc()) == 0)
+    goto bad;
+  if((p = (struct pipe*)kalloc()) == 0)
+    goto bad;
+  if((p->data = kalloc()) == 0)
+    goto bad;
+  p->readopen = 1;
+  p->writeopen = 1;
+  p->nwrite = 0;
+  p->nread = 0;
+  p->rbusy = 0;
+  p->wbusy = 0;
+  initlock(&p->lock, "pipe");
+  (*f0)->type = FD_PIPE;
+  (*f0)->readable = 1;
+  (*f0)->writable = 0;
+  (*f0)->pipe = p;
+  (*f1)->type = FD_PIPE;
+  (*f1)->readable = 0;
+  (*f1)->writable = 1;
+  (*f1)->pipe = p;
+  return 0;
+
+//PAGEBREAK: 20
+ bad:
+  if(p)
+    kfree((char*)p);
+  if(*f0)
+    fileclose(*f0);
+  if(*f1)
+    fileclose(*f1);
+  return -1;
+}
+
+void
+pipeclose(struct pipe *p, int writable)
+{
+  acquire(&p->lock);
+  if(writable){
+    p->writeopen = 0;
+    wakeup(&p->nread);
+  } else {
+    p->readopen = 0;
+    wakeup(&p->nwrite);
+  }
+  if(p->readopen == 0 && p->writeopen == 0){
+    release(&p->lock);
+    kfree(p->data);
+    kfree((char*)p);
+  } else
+    release(&p->lock);
+}
+
+// Bytes, at most n, that fit in one run at p->data + p->nwrite.
+static int
+piperoom(struct pipe *p, int n)
+{
+  n = min(n, PIPESIZE - (p->nwrite - p->nread));
+  return min(n, PIPESIZE - p->nwrite % PIPESIZE);
+}
+
+// Bytes, at most n, that can be taken in one run at p->data + p->nread.
+static int
+pipeavail(struct pipe *p, int n)
+{
+  n = min(n, p->nwrite - p->nread);
+  return min(n, PIPESIZE - p->nread % PIPESIZE);
+}
+
+// Wait until p has room and no splice is writing to it.
+// Returns -1 if the read side is gone.
+static int
+pipewaitroom(struct pipe *p)
+{
+  while(p->nwrite == p->nread + PIPESIZE || p->wbusy){  //DOC: pipewrite-full
+    if(p->readopen == 0 || myproc()->killed)
+      return -1;
+    wakeup(&p->nread);
+    sleep(&p->nwrite, &p->lock);  //DOC: pipewrite-sleep
+  }
+  return 0;
+}
+
+// Wait until p has data or no writer, and no splice is reading
+// from it. Returns -1 if killed.
+static int
+pipewaitdata(struct pipe *p)
+{
+  while((p->nread == p->nwrite && p->writeopen) || p->rbusy){  //DOC: pipe-empty
+    if(myproc()->killed)
+      return -1;
+    sleep(&p->nread, &p->lock); //DOC: piperead-sleep
+  }
+  return 0;
+}
+
+//PAGEBREAK: 40
+// Write the cnt buffers of iov to p.
+int
+pipewritev(struct pipe *p, struct iovec *iov, int cnt)
+{
+  int i, j, m, tot;
+  char *addr;
+
+  tot = 0;
+  acquire(&p->lock);
+  for(j = 0; j < cnt; j++){
+    addr = iov[j].base;
+    for(i = 0; i < iov[j].len; i += m){
+      if(pipewaitroom(p) < 0){
+        release(&p->lock);
+        return -1;
+      }
+      m = piperoom(p, iov[j].len - i);
+      memmove(p->data + p->nwrite % PIPESIZE, addr + i, m);
+      p->nwrite += m;
+    }
+    tot += iov[j].len;
+  }
+  wakeup(&p->nread);  //DOC: pipewrite-wakeup1
+  release(&p->lock);
+  return tot;
+}
+
+// Read from p into the cnt buffers of iov. Waits only until
+// there is something to read.
+int
+pipereadv(struct pipe *p, struct iovec *iov, int cnt)
+{
+  int i, j, m, tot;
+  char *addr;
+
+  acquire(&p->lock);
+  if(pipewaitdata(p) < 0){
+    release(&p->lock);
+    return -1;
+  }
+  tot = 0;
+  for(j = 0; j < cnt; j++){
+    addr = iov[j].base;
+    for(i = 0; i < iov[j].len; i += m){  //DOC: piperead-copy
+      if((m = pipeavail(p, iov[j].len - i)) == 0)
+        break;
+      memmove(addr + i, p->data + p->nread % PIPESIZE, m);
+      p->nread += m;
+    }
+    tot += i;
+    if(i < iov[j].len)
+      break;
+  }
+  wakeup(&p->nwrite);  //DOC: piperead-wakeup
+  release(&p->lock);
+  return tot;
+}
+
+//PAGEBREAK!
+// Splicing. filesplice() moves data between a pipe and an inode
+// with readi()/writei() straight on the pipe's page, which may
+// sleep, so the pipe lock is not held meanwhile. Instead the
+// splicer marks the side it uses busy, which keeps other writers
+// (or readers) off the page until it is done.
+
+// Claim the write side of p once it has room. Sets *buf to where
+// the returned number of bytes, at most n, can go. Returns -1 if
+// the read side is gone. Must be followed by pipewend().
+int
+pipewbegin(struct pipe *p, char **buf, int n)
+{
+  acquire(&p->lock);
+  if(pipewaitroom(p) < 0){
+    release(&p->lock);
+    return -1;
+  }
+  p->wbusy = 1;
+  *buf = p->data + p->nwrite % PIPESIZE;
+  n = piperoom(p, n);
+  release(&p->lock);
+  return n;
+}
+
+// Release the write side after n bytes went into the pipe.
+void
+pipewend(struct pipe *p, int n)
+{
+  acquire(&p->lock);
+  p->nwrite += n;
+  p->wbusy = 0;
+  wakeup(&p->nread);
+  wakeup(&p->nwrite);
+  release(&p->lock);
+}
+
+// Claim the read side of p once it has data. Sets *buf to the
+// returned number of bytes, at most n. Returns 0 at end of file,
+// without claiming, or -1 if killed. Must be followed by piperend().
+int
+piperbegin(struct pipe *p, char **buf, int n)
+{
+  acquire(&p->lock);
+  if(pipewaitdata(p) < 0){
+    release(&p->lock);
+    return -1;
+  }
+  if((n = pipeavail(p, n)) > 0){
+    p->rbusy = 1;
+    *buf = p->data + p->nread % PIPESIZE;
+  }
+  release(&p->lock);
+  return n;
+}
+
+// Release the read side after n bytes were taken from the pipe.
+void
+piperend(struct pipe *p, int n)
+{
+  acquire(&p->lock);
+  p->nread += n;
+  p->rbusy = 0;
+  wakeup(&p->nwrite);
+  wakeup(&p->nread);
+  release(&p->lock);
+}
@@ -0,0 +1,103 @@
+// Pipe throughput: "pipebench [kbytes]" pushes kbytes (default 1024)
+// through a pipe with write() and read(), then moves a file of that
+// size into a pipe, once with read() and write() and once with
+// splice(), and prints the ticks each took.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fcntl.h"
+
+#define CHUNK 4096
+
+char buf[CHUNK];
+
+// Read the pipe p until end of file; return the number of bytes.
+int
+drain(int p)
+{
+  int n, tot;
+
+  tot = 0;
+  while((n = read(p, buf, sizeof(buf))) > 0)
+    tot += n;
+  return tot;
+}
+
+// Run f(arg, fd) in a child writing into a pipe, read it all in the
+// parent, and print the ticks taken.
+void
+run(char *what, void (*f)(int, int), int arg)
+{
+  int p[2], t0, n;
+
+  if(pipe(p) < 0){
+    printf(2, "pipebench: pipe failed\n");
+    exit();
+  }
+  t0 = uptime();
+  if(fork() == 0){
+    close(p[0]);
+    f(arg, p[1]);
+    close(p[1]);
+    exit();
+  }
+  close(p[1]);
+  n = drain(p[0]);
+  close(p[0]);
+  wait();
+  printf(1, "%s: %d bytes in %d ticks\n", what, n, uptime() - t0);
+}
+
+void
+writer(int kbytes, int fd)
+{
+  int i;
+
+  for(i = 0; i < kbytes*1024; i += CHUNK)
+    write(fd, buf, CHUNK);
+}
+
+void
+copier(int unused, int fd)
+{
+  int in, n;
+
+  in = open("pipebench.dat", O_RDONLY);
+  while((n = read(in, buf, sizeof(buf))) > 0)
+    write(fd, buf, n);
+  close(in);
+}
+
+void
+splicer(int unused, int fd)
+{
+  int in;
+
+  in = open("pipebench.dat", O_RDONLY);
+  while(splice(in, fd, CHUNK) > 0)
+    ;
+  close(in);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int fd, kbytes;
+
+  kbytes = 1024;
+  if(argc > 1)
+    kbytes = atoi(argv[1]);
+  memset(buf, 'p', sizeof(buf));
+
+  run("write/read", writer, kbytes);
+
+  fd = open("pipebench.dat", O_CREATE | O_RDWR);
+  writer(kbytes, fd);
+  close(fd);
+  run("file read/write", copier, 0);
+  run("file splice", splicer, 0);
+  unlink("pipebench.dat");
+
+  exit();
+}
@@ -11,6 +11,13 @@
 #include "sleeplock.h"
 #include "fs.h"
 #include "file.h"
+#include "procinfo.h"
+#include "vdso.h"
+
+struct {
+  struct spinlock lock;
+  struct proc proc[NPROC];
+} ptable;
 
 int SOP_PRESENT = 0;
 int SIP_PRESENT = 0;
@@ -30,13 +37,14 @@ close_file(int fd)
   return 0;
 }
 
+// Write n bytes at offset off of file fd, as pwrite() does.
 int
-write_file(int fd, char *p, int n)
+write_file(int fd, char *p, int n, uint off)
 {
   struct file *f;
   if(fd < 0 || fd >= NOFILE || (f=myproc()->ofile[fd]) == 0)
     return -1;
-  return filewrite(f, p, n);
+  return filepwrite(f, p, n, off);
 }
 
 
@@ -59,8 +67,11 @@ create_file(char *path, short type, short major, short minor)
     return 0;
   }
 
-  if((ip = ialloc(dp->dev, type)) == 0)
-    panic("create: ialloc");
+  // Only the tmpfs runs out of inodes; ialloc() panics on the disk.
+  if((ip = ialloc(dp->dev, type)) == 0){
+    iunlockput(dp);
+    return 0;
+  }
 
   ilock(ip);
   ip->major = major;
@@ -146,6 +157,46 @@ int open_file(char *path, int omode){
 
 }
 
+// Remove the file at path, as unlink() does for a plain file.
+int
+unlink_file(char *path)
+{
+  struct inode *ip, *dp;
+  struct dirent de;
+  char name[DIRSIZ];
+  uint off;
+
+  begin_op();
+  if((dp = nameiparent(path, name)) == 0){
+    end_op();
+    return -1;
+  }
+  ilock(dp);
+  if((ip = dirlookup(dp, name, &off)) == 0){
+    iunlockput(dp);
+    end_op();
+    return -1;
+  }
+  ilock(ip);
+  if(ip->type != T_FILE){
+    iunlockput(ip);
+    iunlockput(dp);
+    end_op();
+    return -1;
+  }
+
+  memset(&de, 0, sizeof(de));
+  if(writei(dp, (char*)&de, off, sizeof(de)) != sizeof(de))
+    panic("unlink_file: writei");
+  iunlockput(dp);
+
+  ip->nlink--;
+  iupdate(ip);
+  iunlockput(ip);
+  end_op();
+  return 0;
+}
+
 void num_to_str(int x, char *c){
   if(x==0) {
     c[0] = '0';
@@ -212,26 +263,53 @@ int swap_req_push(struct proc *p, struct swap_req *q){
  
 void SWAP_OUT_PROCESS() {
 
-  acquire(&swap_out_req.lock);
-  while(swap_out_req.start != swap_out_req.end){
-    struct proc *p = swap_req_pop(&swap_out_req);
+  struct proc *p;
+  // swap_req_pop() takes the queue lock itself; it must not be held
+  // across the file system calls below, which may sleep.
+  while((p = swap_req_pop(&swap_out_req)) != 0){
+
+    // The requester may have been killed (and even reaped) meanwhile.
+    if(p->killed || p->state == ZOMBIE || p->state == UNUSED)
+      continue;
 
+    // Evict the requester's coldest pages first: those with the
+    // highest age, i.e. the most aging passes since they were last
+    // referenced (see PAGE_AGING_PROCESS).
     pde_t* pgdir = p->pgdir;
-    for(int i=0; i<NPDENTRIES; i++){ // going throigh the page directory entries.
+    int pid = p->pid;
+    int maxage = -1;
+    for(int i=0; i<PDX(KERNBASE); i++){
+      if(!(pgdir[i] & PTE_P)) continue;
+      pte_t *pgtab = (pte_t*)P2V(PTE_ADDR(pgdir[i]));
+      for(int j=0; j<NPTENTRIES; j++)
+        if((pgtab[j]&PTE_P) && (pgtab[j]&PTE_U) && PGADDR(i, j, 0) < VDSOPROC && (int)PTE_AGE(pgtab[j]) > maxage)
+          maxage = PTE_AGE(pgtab[j]);
+    }
+
+    int freed = 0, stop = 0;
+    for(int i=0; i<PDX(KERNBASE) && !stop && freed < SWAPBATCH; i++){ // going throigh the user page directory entries.
+
+      if(!(pgdir[i] & PTE_P)) continue;
 
-      //skip page table if accessed. chances are high, not every page table was accessed.
-      if(pgdir[i] & PTE_A) continue;
-      
       pte_t *pgtab = (pte_t*)P2V(PTE_ADDR(pgdir[i]));
-      for(int j=0; j<NPTENTRIES; j++){ // going through the the page table entries
+      for(int j=0; j<NPTENTRIES && freed < SWAPBATCH; j++){ // going through the the page table entries
 
-        //Skip if found
-        if((pgtab[j]&PTE_A) || !(pgtab[j]&PTE_P)) continue;
+        if(!(pgtab[j]&PTE_P) || !(pgtab[j]&PTE_U) || (int)PTE_AGE(pgtab[j]) != maxage) continue;
+        if(PGADDR(i, j, 0) >= VDSOPROC) continue;  // shared with the kernel
         
         pte_t *pte = (pte_t*)P2V(PTE_ADDR(pgtab[j]));
 
-        //for file name
-        int pid = p->pid;
+        // Zero and compressible pages stay in RAM (see zswap.c); only
+        // the rest is written to a swap file.
+        uint where = zswap_store((char*)pte);
+        if(where){
+          pgtab[j] = where | 0x080;
+          p->rss--;
+          p->nswap++;
+          freed++;
+          continue;
+        }
+
         // file name contians virtual address of the swaping out which helps SWAP_IN_PROCESS 
         // to swap in a particular page fault at a given address by the process.
         int virt_addr = ((1<<22)*i)+((1<<12)*j); 
@@ -243,34 +321,58 @@ void SWAP_OUT_PROCESS() {
         num_to_str(virt_addr,c+x+1);
         safestrcpy(c+strlen(c),".swp",5);
 
-        // file management
+        // file management. If the swap space is exhausted, stop swapping
+        // for this request and let the OOM killer make room instead.
         int fd = open_file(c, O_CREATE | O_RDWR);
         if(fd<0){
-          cprintf("error creating or opening file: %start\n", c);
-          panic("SWAP_OUT_PROCESS");
+          cprintf("SWAP_OUT_PROCESS: cannot create %s\n", c);
+          stop = 1;
+          break;
         }
 
-        if(write_file(fd,(char *)pte, PGSIZE) != PGSIZE){
-          cprintf("error writing to file: %start\n", c);
-          panic("SWAP_OUT_PROCESS");
+        // Clear the dirty bit before copying the page out, so that a
+        // write by the owner while write_file() sleeps shows up below.
+        pgtab[j] &= ~PTE_D;
+        if(write_file(fd,(char *)pte, PGSIZE, 0) != PGSIZE){
+          cprintf("SWAP_OUT_PROCESS: cannot write %s\n", c);
+          close_file(fd);
+          stop = 1;
+          break;
         }
         close_file(fd);
 
+        // The write may have slept. If the requester exited or exec'ed
+        // meanwhile, its page tables (and this page) are already gone.
+        if(p->pid != pid || p->state == ZOMBIE || p->state == UNUSED || p->pgdir != pgdir){
+          stop = 1;
+          break;
+        }
+
+        // The page must also still be mapped here, and unwritten: sbrk
+        // may have freed it, or the owner changed it after the copy.
+        // Keep it in RAM then, and drop the stale copy.
+        if(!(pgtab[j] & PTE_P) || PTE_ADDR(pgtab[j]) != V2P(pte) || (pgtab[j] & PTE_D)){
+          unlink_file(c);
+          continue;
+        }
+
         kfree((char*)pte); // freeing this page and adding it back to the freelist pages.
         memset(&pgtab[j], 0, sizeof(pgtab[j]));
 
         //mark this page as being swapped out.
         pgtab[j] = ((pgtab[j])^(0x080));
-
-        break;
+        p->rss--;
+        p->nswap++;
+        freed++;
       }
     }
 
+    // Nothing could be swapped out for this request, so the requester
+    // would sleep on swapsleep forever. Kill something instead.
+    if(freed == 0)
+      oom_kill();
   }
 
-  release(&swap_out_req.lock);
-  
-  struct proc *p;
   if((p=myproc()) == 0)
     panic("swap out process");
 
@@ -278,53 +380,85 @@ void SWAP_OUT_PROCESS() {
   p->parent = 0;
   p->name[0] = '*';
   p->killed = 0;
-  p->state = UNUSED; // Killing this swapping out process.
+  acquire(&ptable.lock);
+  p->state = ZOMBIE; // Killing this swapping out process; the scheduler frees it.
   sched(); // calling scheduler.
 }
 
-int read_file(int fd, int n, char *p)
+// Read n bytes at offset off of file fd, as pread() does.
+int read_file(int fd, int n, char *p, uint off)
 {
   struct file *f;
   if(fd < 0 || fd >= NOFILE || (f=myproc()->ofile[fd]) == 0)
   return -1;
-  return fileread(f, p, n);
+  return filepread(f, p, n, off);
 
 }
 
 void SWAP_IN_PROCESS() {
-    
-    acquire(&swap_in_req.lock);
-    while(swap_in_req.start != swap_in_req.end){
-		struct proc *p = swap_req_pop(&swap_in_req);
+
+    struct proc *p;
+    // As in SWAP_OUT_PROCESS, the queue lock is not held across file I/O.
+    while((p = swap_req_pop(&swap_in_req)) != 0){
 
 		int pid = p->pid;
 		int virt_addr = PTE_ADDR(p->PGFLT_addr);
 
-		char c[50];
-		num_to_str(pid,c);
-		int x = strlen(c);
-		c[x] = '-';
-		num_to_str(virt_addr,c+x+1); // getting the page which existed at this va before getting swapped out.
-		safestrcpy(c+strlen(c),".swp",5);
-
-		int fd = open_file(c,O_RDONLY);
-		if(fd<0){
-			release(&swap_in_req.lock);
-			cprintf("could not find page file in memory: %start\n", c);
-			panic("SWAP_IN_PROCESS");
+		char *mem;
+		while((mem = kalloc()) == 0){
+			// No page to bring it back into: make room, and sleep until
+			// kfree() hands a page back.
+			oom_kill();
+			acquire(&swapsleeplock);
+			swapsleepcount++;
+			sleep(swapsleep, &swapsleeplock);
+			release(&swapsleeplock);
+		}
+		if(p->killed || p->state == ZOMBIE || p->state == UNUSED){
+			// The faulting process was the one killed.
+			kfree(mem);
+			continue;
 		}
-		char *mem = kalloc();
-		read_file(fd,PGSIZE,mem);
 
-		if(mappages(p->pgdir, (void *)virt_addr, PGSIZE, V2P(mem), PTE_W|PTE_U)<0){
-			release(&swap_in_req.lock);
-			panic("mappages");
+		pte_t *pgtab = (pte_t*)P2V(PTE_ADDR(p->pgdir[PDX(virt_addr)]));
+		if(!zswap_ondisk(pgtab[PTX(virt_addr)])){
+			// Zero or compressed page, see zswap.c.
+			// The PTE keeps its swap bit until mappages() below, so
+			// that the faulting process keeps waiting for it.
+			zswap_load(pgtab[PTX(virt_addr)], mem);
+		} else {
+			char c[50];
+			num_to_str(pid,c);
+			int x = strlen(c);
+			c[x] = '-';
+			num_to_str(virt_addr,c+x+1); // getting the page which existed at this va before getting swapped out.
+			safestrcpy(c+strlen(c),".swp",5);
+
+			int fd = open_file(c,O_RDONLY);
+			if(fd<0){
+				cprintf("could not find page file in memory: %s\n", c);
+				panic("SWAP_IN_PROCESS");
+			}
+			read_file(fd,PGSIZE,mem,0);
+			close_file(fd);
+			if(p->pid != pid || p->killed || p->state == ZOMBIE || p->state == UNUSED){
+				// Killed while the page was being read.
+				kfree(mem);
+				continue;
+			}
 		}
+
+		// Under swapinlock, so that the faulting process is either
+		// not yet asleep and sees the page, or asleep and woken.
+		acquire(&swapinlock);
+		if(mappages(p->pgdir, (void *)virt_addr, PGSIZE, V2P(mem), PTE_W|PTE_U)<0)
+			panic("mappages");
+		p->rss++;
+		p->nswap--;
 		wakeup(p);
+		release(&swapinlock);
 	}
 
-    release(&swap_in_req.lock);
-    struct proc *p;
 	if((p=myproc()) == 0)
 	  panic("SWAP_IN_PROCESS");
 
@@ -332,14 +466,43 @@ void SWAP_IN_PROCESS() {
 	p->parent = 0;
 	p->name[0] = '*';
 	p->killed = 0;
-	p->state = UNUSED;
+	acquire(&ptable.lock);
+	p->state = ZOMBIE; // the scheduler frees it.
 	sched(); // calling the scheduler.
 }
 
-struct {
-  struct spinlock lock;
-  struct proc proc[NPROC];
-} ptable;
+// Background page aging, so that the swapper knows which pages are
+// cold without walking page tables on every dispatch. Every AGETICKS
+// ticks, age the pages of each process and record its working set.
+// Clearing PTE_A is not followed by a TLB flush, so the CPU only sets
+// it again when it next walks the page tables. A RUNNING process may
+// have its translations cached on another CPU, so it is skipped and
+// keeps its ages until it is off the CPU. Since switchuvm() does not
+// reload an unchanged %cr3, an idle CPU can still hold translations
+// for the process that last ran on it; such a page can look older
+// than it is, which only makes it an earlier swap-out candidate.
+void PAGE_AGING_PROCESS() {
+
+  struct proc *p;
+  uint ticks0;
+
+  for(;;){
+    acquire(&tickslock);
+    ticks0 = ticks;
+    while(ticks - ticks0 < AGETICKS)
+      sleep(&ticks, &tickslock);
+    release(&tickslock);
+
+    acquire(&ptable.lock);
+    for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+      if(p->state == UNUSED || p->state == EMBRYO || p->state == ZOMBIE ||
+         p->state == RUNNING || p->sz == 0)
+        continue;
+      p->wss = ageuvm(p->pgdir, p->sz);
+    }
+    release(&ptable.lock);
+  }
+}
 
 static struct proc *initproc;
 
@@ -357,6 +520,7 @@ pinit(void)
   initlock(&swap_out_req.lock, "swap_out_req");
   initlock(&swapsleeplock, "swapsleep");
   initlock(&swap_in_req.lock, "swap_in_req");
+  zswapinit();
 }
 
 // Must be called with interrupts disabled
@@ -421,6 +585,11 @@ allocproc(void)
 found:
   p->state = EMBRYO;
   p->pid = nextpid++;
+  p->rss = 0;
+  p->nswap = 0;
+  p->wss = 0;
+  p->ioctx = 0;
+  p->vdso = 0;
 
   release(&ptable.lock);
 
@@ -462,8 +631,10 @@ void create_kernel_process(const char *name, void (*entrypoint)()){
   //This is a kernel process. Trap frame stores user space registers. We don't need to initialise tf.
   //Also, since this doesn't need to have a userspace, we don't need to assign a size to this process.
 
-  //eip stores address of next instruction to be executed
-  p->context->eip = (uint)entrypoint;
+  //eip stores address of next instruction to be executed. Start in forkret,
+  //which releases ptable.lock like for any new process, and "return" from
+  //it into entrypoint instead of trapret.
+  *(uint*)((char*)p->context + sizeof(*p->context)) = (uint)entrypoint;
 
   safestrcpy(p->name, name, sizeof(p->name));
 
@@ -498,7 +669,10 @@ userinit(void)
   if((p->pgdir = setupkvm()) == 0)
     panic("userinit: out of memory?");
   inituvm(p->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
+  if((p->vdso = vdsomap(p->pgdir, p->pid)) == 0)
+    panic("userinit: out of memory?");
   p->sz = PGSIZE;
+  p->rss = 1;
   memset(p->tf, 0, sizeof(*p->tf));
   p->tf->cs = (SEG_UCODE << 3) | DPL_USER;
   p->tf->ds = (SEG_UDATA << 3) | DPL_USER;
@@ -520,6 +694,11 @@ userinit(void)
   p->state = RUNNABLE;
 
   release(&ptable.lock);
+
+  create_kernel_process("PAGE_AGING", &PAGE_AGING_PROCESS);
+  create_kernel_process("LOG_COMMIT", &LOG_COMMIT_PROCESS);
+  ioringinit();
+  create_kernel_process("IORING", &IORING_PROCESS);
 }
 
 // Grow current process's memory by n bytes.
@@ -538,8 +717,12 @@ growproc(int n)
     if((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
       return -1;
   }
+  // Pages were mapped or unmapped between the old and new page-rounded size.
+  curproc->rss += (int)(PGROUNDUP(sz) - PGROUNDUP(curproc->sz)) / PGSIZE;
   curproc->sz = sz;
-  switchuvm(curproc);
+  // switchuvm() does not reload an address space that is already
+  // loaded, so flush the TLB here to drop the unmapped pages.
+  lcr3(V2P(curproc->pgdir));
   return 0;
 }
 
@@ -559,13 +742,18 @@ fork(void)
   }
 
   // Copy process state from proc.
-  if((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0){
+  if((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0 ||
+     (np->vdso = vdsomap(np->pgdir, np->pid)) == 0){
+    if(np->pgdir)
+      freevm(np->pgdir);
+    np->pgdir = 0;
     kfree(np->kstack);
     np->kstack = 0;
     np->state = UNUSED;
     return -1;
   }
   np->sz = curproc->sz;
+  np->rss = curproc->rss;
   np->parent = curproc;
   *np->tf = *curproc->tf;
 
@@ -603,6 +791,9 @@ exit(void)
   if(curproc == initproc)
     panic("init exiting");
 
+  // Wait for I/O ring requests, which write to our memory.
+  ioringfree(curproc);
+
   // Close all open files.
   for(fd = 0; fd < NOFILE; fd++){
     if(curproc->ofile[fd]){
@@ -663,6 +854,9 @@ wait(void)
         p->parent = 0;
         p->name[0] = 0;
         p->killed = 0;
+        p->rss = 0;
+        p->nswap = 0;
+        p->wss = 0;
         p->state = UNUSED;
         release(&ptable.lock);
         return pid;
@@ -703,45 +897,44 @@ scheduler(void)
     acquire(&ptable.lock);
     for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
     
-      //If the swap processes have stopped running, free its stack and name.
-      if(p->state==UNUSED && p->name[0]=='*'){
+      //If the swap processes have stopped running, free its stack, page directory and name.
+      //They have no parent to reap them, and the slot only becomes UNUSED
+      //once nothing is left in it for allocproc() to trip over.
+      if(p->state==ZOMBIE && p->parent==0 && p->name[0]=='*'){
         kfree(p->kstack);
         p->kstack = 0;
+        switchkvm(); // its page directory may still be loaded.
+        freevm(p->pgdir);
+        p->pgdir = 0;
         p->name[0] = 0;
         p->pid = 0;
+        p->state = UNUSED;
       }
 
       if(p->state != RUNNABLE)
         continue;
 
-      // we will reset the access bit of the selected process as we will just mark a recently used if it used in the last quantum of the process.
-      for(int i=0; i<NPDENTRIES; i++){
-        //If PDE was accessed
-
-        if(((p->pgdir)[i])&PTE_P && ((p->pgdir)[i])&PTE_A){
-          pte_t* pgtab = (pte_t*)P2V(PTE_ADDR((p->pgdir)[i]));
-          for(int j=0; j<NPTENTRIES; j++){
-            if(pgtab[j] & PTE_A){
-              pgtab[j] ^= PTE_A;
-            }
-          }
-          ((p->pgdir)[i]) ^= PTE_A;
-        }
-      }
       // Switch to chosen process.  It is the process's job
       // to release ptable.lock and then reacquire it
       // before jumping back to us.
       c->proc = p;
       switchuvm(p);
       p->state = RUNNING;
+      if(p->vdso)
+        p->vdso->cpu = c - cpus;
 
       swtch(&(c->scheduler), p->context);
-      switchkvm();
+      // No switchkvm() here: the kernel half is the same in every page
+      // directory, so stay on p's and let the next switchuvm() decide.
 
       // Process is done running for now.
       // It should have changed its p->state before coming back.
       c->proc = 0;
     }
+    // Once ptable.lock is dropped another CPU may run, exec or reap the
+    // process whose page directory is still loaded here and free it.
+    if(ncpu > 1)
+      switchkvm();
     release(&ptable.lock);
 
   }
@@ -799,6 +992,7 @@ forkret(void)
     first = 0;
     iinit(ROOTDEV);
     initlog(ROOTDEV);
+    tmpmount("/tmp");
   }
 
   // Return to "caller", actually trapret (see allocproc).
@@ -888,6 +1082,97 @@ kill(int pid)
   return -1;
 }
 
+// How much memory killing p would give back, in pages: its resident
+// and swapped-out user pages. -1 if p must not be picked: init, the
+// kernel's own processes (no user memory) and processes already dying.
+// The ptable lock must be held.
+static int
+oom_badness(struct proc *p)
+{
+  if(p->state == UNUSED || p->state == EMBRYO || p->state == ZOMBIE)
+    return -1;
+  if(p == initproc || p->sz == 0 || p->killed)
+    return -1;
+  return p->rss + p->nswap;
+}
+
+// Out of memory with nothing left to swap out: kill the process with
+// the highest badness the same way kill() does, instead of panicking
+// or leaving allocators asleep forever. Its pages come back when it
+// exits and is reaped. Returns the victim's pid, or -1 if none.
+int
+oom_kill(void)
+{
+  static int oompid;  // last victim
+  struct proc *p, *victim;
+  int score, maxscore, pid, rss, nswap;
+  char name[16];
+
+  acquire(&ptable.lock);
+  // Until the last victim has been reaped it still holds its memory;
+  // wait for that rather than killing another process.
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if(oompid != 0 && p->pid == oompid && p->state != UNUSED){
+      release(&ptable.lock);
+      return -1;
+    }
+  }
+  victim = 0;
+  maxscore = 0;
+  for(p = ptable.proc; p < &ptable.proc[NPROC]; p++){
+    if((score = oom_badness(p)) > maxscore){
+      maxscore = score;
+      victim = p;
+    }
+  }
+  if(victim == 0){
+    release(&ptable.lock);
+    cprintf("oom: no process to kill\n");
+    return -1;
+  }
+  victim->killed = 1;
+  // Wake process from sleep if necessary.
+  if(victim->state == SLEEPING)
+    victim->state = RUNNABLE;
+  pid = oompid = victim->pid;
+  rss = victim->rss;
+  nswap = victim->nswap;
+  safestrcpy(name, victim->name, sizeof(name));
+  release(&ptable.lock);
+
+  cprintf("oom: killed pid %d (%s) score %d: rss %d swap %d pages\n",
+          pid, name, maxscore, rss, nswap);
+  return pid;
+}
+
+// Copy the memory statistics of process table slot i to *pi.
+// Returns 0 on success, -1 if the slot is unused and -2 past the end.
+int
+getprocinfo(int i, struct procinfo *pi)
+{
+  struct proc *p;
+
+  if(i < 0 || i >= NPROC)
+    return -2;
+  acquire(&ptable.lock);
+  p = &ptable.proc[i];
+  if(p->state == UNUSED){
+    release(&ptable.lock);
+    return -1;
+  }
+  pi->pid = p->pid;
+  pi->state = p->state;
+  safestrcpy(pi->name, p->name, sizeof(pi->name));
+  pi->sz = p->sz;
+  pi->rss = p->rss;
+  pi->nswap = p->nswap;
+  pi->wss = p->wss;
+  pi->oomscore = oom_badness(p);
+  pi->killed = p->killed;
+  release(&ptable.lock);
+  return 0;
+}
+
 //PAGEBREAK: 36
 // Print a process listing to console.  For debugging.
 // Runs when user types ^P on console.
@@ -915,7 +1200,7 @@ procdump(void)
       state = states[p->state];
     else
       state = "???";
-    cprintf("%d %s %s", p->pid, state, p->name);
+    cprintf("%d %s %s rss %d swap %d wss %d", p->pid, state, p->name, p->rss, p->nswap, p->wss);
     if(p->state == SLEEPING){
       getcallerpcs((uint*)p->context->ebp+2, pc);
       for(i=0; i<10 && pc[i] != 0; i++)
@@ -923,4 +1208,5 @@ procdump(void)
     }
     cprintf("\n");
   }
+  zswapdump();
 }
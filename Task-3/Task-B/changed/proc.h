@@ -50,6 +50,11 @@ struct proc {
   struct inode *cwd;           // Current directory
   char name[16];               // Process name (debugging)
   int PGFLT_addr;              // Virtual address at where the page fault occurs.
+  int rss;                     // User pages resident in memory
+  int nswap;                   // User pages swapped out to disk
+  int wss;                     // Working set: pages referenced in the last WSWINDOW aging passes
+  struct ioctx *ioctx;         // I/O ring, if set up (see ioring.c)
+  struct vdsoproc *vdso;       // Page at VDSOPROC, if a user process (see vdso.h)
 };
 
 // Process memory is laid out contiguously, low addresses first:
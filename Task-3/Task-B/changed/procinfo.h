@@ -0,0 +1,13 @@
+// Per-process memory statistics, filled in by getprocinfo().
+// Both the kernel and user programs use this header file.
+struct procinfo {
+  int pid;
+  int state;      // enum procstate in proc.h
+  char name[16];
+  uint sz;        // size of process memory (bytes)
+  int rss;        // user pages resident in memory
+  int nswap;      // user pages swapped out to disk
+  int wss;        // working set estimate, in pages
+  int oomscore;   // badness the OOM killer ranks by, -1 if exempt
+  int killed;     // marked for exit (by kill() or the OOM killer)
+};
@@ -0,0 +1,30 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "procinfo.h"
+
+// List processes with their memory use, working set and OOM badness.
+
+static char *states[] = {
+  "unused", "embryo", "sleep ", "runble", "run   ", "zombie"
+};
+
+int
+main(int argc, char *argv[]){
+
+	struct procinfo pi;
+	int r;
+
+	printf(1, "pid\tstate\tsize\trss\tswap\twss\toom\tname\n");
+	for(int i=0; (r = getprocinfo(i, &pi)) != -2; i++){
+		if(r < 0)
+			continue;
+		printf(1, "%d\t%s\t%d\t%d\t%d\t%d\t", pi.pid, states[pi.state], pi.sz, pi.rss, pi.nswap, pi.wss);
+		if(pi.oomscore < 0)
+			printf(1, "-");
+		else
+			printf(1, "%d", pi.oomscore);
+		printf(1, "\t%s%s\n", pi.name, pi.killed ? " (killed)" : "");
+	}
+	exit();
+}
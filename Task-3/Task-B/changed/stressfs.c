@@ -0,0 +1,84 @@
+// Demonstrate that moving the "acquire" in iderw after the loop that
+// appends to the idequeue results in a race.
+
+// For this to work, you should also add a spin within iderw's
+// idequeue traversal loop.  Adding the following demonstrated a panic
+// after about 5 runs of stressfs in QEMU on a 2.1GHz CPU:
+//    for (i = 0; i < 40000; i++)
+//      asm volatile("");
+
+// Also measures file system throughput: "stressfs [nblocks [dir]]" has
+// each of the 5 processes write and then read back nblocks (default 20)
+// blocks in directory dir (default the current one), and reports the
+// ticks taken and the block cache activity. Compare "stressfs 200 /"
+// with "stressfs 200 /tmp" to see what the tmpfs saves.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fs.h"
+#include "fcntl.h"
+#include "iostat.h"
+
+int
+main(int argc, char *argv[])
+{
+  int fd, i, id, nblocks, t0, t1, t2;
+  char path[] = "stressfs0";
+  char data[512];
+  struct iostat st0, st;
+
+  nblocks = 20;
+  if(argc > 1)
+    nblocks = atoi(argv[1]);
+  if(argc > 2 && chdir(argv[2]) < 0){
+    printf(2, "stressfs: cannot cd to %s\n", argv[2]);
+    exit();
+  }
+
+  printf(1, "stressfs starting\n");
+  memset(data, 'a', sizeof(data));
+  iostat(&st0);
+
+  for(id = 0; id < 4; id++)
+    if(fork() > 0)
+      break;
+
+  printf(1, "write %d\n", id);
+
+  t0 = uptime();
+  path[8] += id;
+  fd = open(path, O_CREATE | O_RDWR);
+  for(i = 0; i < nblocks; i++)
+//    printf(fd, "%d\n", i);
+    write(fd, data, sizeof(data));
+  close(fd);
+
+  printf(1, "read\n");
+
+  t1 = uptime();
+  fd = open(path, O_RDONLY);
+  for (i = 0; i < nblocks; i++)
+    read(fd, data, sizeof(data));
+  close(fd);
+  t2 = uptime();
+
+  printf(1, "%d: %d blocks written in %d ticks, read in %d ticks\n",
+         id, nblocks, t1 - t0, t2 - t1);
+
+  wait();
+
+  if(id == 0){
+    iostat(&st);
+    printf(1, "bcache: %d hits, %d misses, %d evictions, %d read ahead\n",
+           st.bhits - st0.bhits, st.bmisses - st0.bmisses,
+           st.bevictions - st0.bevictions, st.breadahead - st0.breadahead);
+    printf(1, "disk: %d commands, %d blocks\n",
+           st.ireqs - st0.ireqs, st.iblocks - st0.iblocks);
+    printf(1, "log: %d commits, %d blocks, %d system calls\n",
+           st.lcommits - st0.lcommits, st.lblocks - st0.lblocks,
+           st.lops - st0.lops);
+  }
+
+  exit();
+}
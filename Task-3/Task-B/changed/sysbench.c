@@ -0,0 +1,50 @@
+// System call cost: "sysbench [n]" gets the pid n (default 10000)
+// times each by int $T_SYSCALL, by sysenter, as the C library makes
+// system calls, and from the vDSO page, as getpid() does, and prints
+// the cycles each took on average.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Low half of the time stamp counter: enough for differences.
+static inline uint
+rdtsc(void)
+{
+  uint lo, hi;
+
+  asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+  return lo;
+}
+
+void
+run(char *what, int (*f)(void), int n)
+{
+  uint t0;
+  int i;
+
+  f();  // warm up
+  t0 = rdtsc();
+  for(i = 0; i < n; i++)
+    f();
+  printf(1, "%s: %d cycles per getpid\n", what, (rdtsc() - t0) / n);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int n;
+
+  n = 10000;
+  if(argc > 1)
+    n = atoi(argv[1]);
+  if(n <= 0){
+    printf(2, "usage: sysbench [n]\n");
+    exit();
+  }
+
+  run("int $T_SYSCALL", trapgetpid, n);
+  run("sysenter", sysgetpid, n);
+  run("vdso", getpid, n);
+  exit();
+}
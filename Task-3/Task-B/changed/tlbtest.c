@@ -0,0 +1,61 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Two processes ping-pong a byte over a pair of pipes. Every round
+// trip is two context switches, and between them each side touches
+// its own set of pages, so the run time is dominated by the TLB
+// misses taken after each switch.
+
+int
+main(int argc, char *argv[]){
+
+	int rounds = 2000, npages = 16;
+	int ping[2], pong[2];
+	char c = 0;
+
+	if(argc > 1)
+		rounds = atoi(argv[1]);
+	if(argc > 2)
+		npages = atoi(argv[2]);
+
+	if(pipe(ping) < 0 || pipe(pong) < 0){
+		printf(1, "tlbtest: pipe failed\n");
+		exit();
+	}
+
+	char *mem = sbrk(npages*4096);
+	if(mem == (char*)-1){
+		printf(1, "tlbtest: sbrk failed\n");
+		exit();
+	}
+	for(int i=0; i<npages; i++)
+		mem[i*4096] = i;
+
+	int start = uptime();
+	int pid = fork();
+	if(pid < 0){
+		printf(1, "tlbtest: fork failed\n");
+		exit();
+	}
+	for(int r=0; r<rounds; r++){
+		if(pid == 0){
+			read(ping[0], &c, 1);
+			for(int i=0; i<npages; i++)
+				c += mem[i*4096];
+			write(pong[1], &c, 1);
+		} else {
+			for(int i=0; i<npages; i++)
+				c += mem[i*4096];
+			write(ping[1], &c, 1);
+			read(pong[0], &c, 1);
+		}
+	}
+	if(pid == 0)
+		exit();
+	wait();
+
+	printf(1, "%d round trips, %d pages touched per switch: %d ticks\n",
+		rounds, npages, uptime() - start);
+	exit();
+}
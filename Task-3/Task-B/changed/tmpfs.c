@@ -0,0 +1,207 @@
+// RAM-backed file system, mounted on /tmp.
+//
+// A tmpfs file is a tnode. The inode cache treats it like any other
+// inode, on device TMPDEV with the tnode's index as inode number, and
+// fs.c calls in here where it would read or write the disk. The
+// contents live in kalloc()ed pages, listed in a page of pointers
+// that is allocated on the first write, so a file holds up to NTMAP
+// pages. Nothing goes through the log or the disk, and the files are
+// gone after a reboot.
+//
+// The fields of a tnode are protected by the sleep-lock of its
+// inode; tmpfs.lock protects allocation of tnodes and pages.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "stat.h"
+#include "mmu.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "fs.h"
+#include "file.h"
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define NTMAP (PGSIZE / sizeof(char*))
+
+struct tnode {
+  short type;   // 0 if free
+  short major;
+  short minor;
+  short nlink;
+  uint size;
+  char **map;   // pages holding the contents
+};
+
+struct {
+  struct spinlock lock;
+  struct tnode tnode[NTNODE];
+  int npages;   // pages in use, including maps
+} tmpfs;
+
+// Set up an empty tmpfs: just the root directory, whose
+// entries the caller adds.
+void
+tmpfsinit(void)
+{
+  initlock(&tmpfs.lock, "tmpfs");
+  tmpfs.tnode[ROOTINO].type = T_DIR;
+  tmpfs.tnode[ROOTINO].nlink = 1;
+}
+
+static char*
+tmpfspage(void)
+{
+  char *pg;
+
+  acquire(&tmpfs.lock);
+  pg = 0;
+  if(tmpfs.npages < TMPPAGES && (pg = kalloc()) != 0){
+    memset(pg, 0, PGSIZE);
+    tmpfs.npages++;
+  }
+  release(&tmpfs.lock);
+  return pg;
+}
+
+static void
+tmpfsfree(char *pg)
+{
+  kfree(pg);
+  acquire(&tmpfs.lock);
+  tmpfs.npages--;
+  release(&tmpfs.lock);
+}
+
+// Allocate a tnode of the given type and return its number,
+// or 0 if there are none left.
+uint
+tmpfsialloc(short type)
+{
+  struct tnode *t;
+
+  acquire(&tmpfs.lock);
+  for(t = &tmpfs.tnode[ROOTINO+1]; t < &tmpfs.tnode[NTNODE]; t++){
+    if(t->type == 0){
+      memset(t, 0, sizeof(*t));
+      t->type = type;
+      release(&tmpfs.lock);
+      return t - tmpfs.tnode;
+    }
+  }
+  release(&tmpfs.lock);
+  return 0;
+}
+
+// Copy tnode ip->inum into ip, for ilock().
+void
+tmpfsiload(struct inode *ip)
+{
+  struct tnode *t;
+
+  t = &tmpfs.tnode[ip->inum];
+  ip->type = t->type;
+  ip->major = t->major;
+  ip->minor = t->minor;
+  ip->nlink = t->nlink;
+  ip->size = t->size;
+  memset(ip->addrs, 0, sizeof(ip->addrs));
+}
+
+// Copy ip back into its tnode, for iupdate(). Type 0 frees it.
+void
+tmpfsiupdate(struct inode *ip)
+{
+  struct tnode *t;
+
+  t = &tmpfs.tnode[ip->inum];
+  t->major = ip->major;
+  t->minor = ip->minor;
+  t->nlink = ip->nlink;
+  t->size = ip->size;
+  if(ip->type == 0 && t->map)
+    panic("tmpfsiupdate");
+  acquire(&tmpfs.lock);
+  t->type = ip->type;
+  release(&tmpfs.lock);
+}
+
+// Free the contents of ip, for itrunc().
+void
+tmpfsitrunc(struct inode *ip)
+{
+  struct tnode *t;
+  int i;
+
+  t = &tmpfs.tnode[ip->inum];
+  if(t->map){
+    for(i = 0; i < NTMAP; i++)
+      if(t->map[i])
+        tmpfsfree(t->map[i]);
+    tmpfsfree((char*)t->map);
+    t->map = 0;
+  }
+}
+
+// Read n bytes at off from ip, which has at least off+n bytes.
+int
+tmpfsread(struct inode *ip, char *dst, uint off, uint n)
+{
+  struct tnode *t;
+  uint tot, m;
+  char *pg;
+
+  t = &tmpfs.tnode[ip->inum];
+  for(tot=0; tot<n; tot+=m, off+=m, dst+=m){
+    m = min(n - tot, PGSIZE - off%PGSIZE);
+    if(t->map && (pg = t->map[off/PGSIZE]) != 0)
+      memmove(dst, pg + off%PGSIZE, m);
+    else
+      memset(dst, 0, m);
+  }
+  return n;
+}
+
+// Write n bytes at off to ip. Returns n, or -1 if tmpfs is out of
+// pages; filewrite() does not expect short writes. A failed write
+// gives back the pages it added past the end of the file, so that
+// they are not left charged to the tmpfs.
+int
+tmpfswrite(struct inode *ip, char *src, uint off, uint n)
+{
+  struct tnode *t;
+  uint tot, m, i;
+  char *pg;
+
+  if(off + n > NTMAP*PGSIZE)
+    return -1;
+
+  t = &tmpfs.tnode[ip->inum];
+  if(t->map == 0 && (t->map = (char**)tmpfspage()) == 0)
+    return -1;
+  for(tot=0; tot<n; tot+=m, off+=m, src+=m){
+    m = min(n - tot, PGSIZE - off%PGSIZE);
+    if((pg = t->map[off/PGSIZE]) == 0){
+      if((pg = tmpfspage()) == 0)
+        goto bad;
+      t->map[off/PGSIZE] = pg;
+    }
+    memmove(pg + off%PGSIZE, src, m);
+  }
+  return n;
+
+bad:
+  // Pages below the old end of the file may hold data already;
+  // none past it does, so those were allocated by this write.
+  for(i = PGROUNDUP(ip->size)/PGSIZE; i < NTMAP; i++){
+    if(t->map[i]){
+      tmpfsfree(t->map[i]);
+      t->map[i] = 0;
+    }
+  }
+  if(ip->size == 0){
+    tmpfsfree((char*)t->map);
+    t->map = 0;
+  }
+  return -1;
+}
@@ -7,6 +7,7 @@
 #include "x86.h"
 #include "traps.h"
 #include "spinlock.h"
+#include "vdso.h"
 
 // Interrupt descriptor table (shared by all CPUs).
 struct gatedesc idt[256];
@@ -16,24 +17,52 @@ uint ticks;
 
 struct spinlock swapinlock;
 
+// Bring back the current process's swapped-out page at addr: queue
+// a request for SWAP_IN_PROCESS and sleep until the page is mapped
+// again (or the OOM killer picked this process). SWAP_IN_PROCESS
+// maps it and wakes us holding swapinlock, so the wakeup cannot slip
+// in before the sleep, and other wakeups on p do not end the wait.
+void
+swapinpage(uint addr)
+{
+  struct proc *p = myproc();
+  pte_t *pte = &((pte_t*)P2V(PTE_ADDR(p->pgdir[PDX(addr)])))[PTX(addr)];
+  char *mem;
+
+  // Zero and compressed pages (see zswap.c) need no disk I/O: bring
+  // them back right here, without waking SWAP_IN_PROCESS, if there
+  // is a free page. A non-present PTE is never cached in the TLB.
+  if(!zswap_ondisk(*pte) && (mem = kalloc()) != 0){
+    zswap_load(*pte, mem);
+    *pte = V2P(mem) | PTE_P | PTE_W | PTE_U;
+    p->rss++;
+    p->nswap--;
+    return;
+  }
+
+  // storing the address where page fault occurs. This is later used to swap in the respective file .swp file
+  acquire(&swapinlock);
+  p->PGFLT_addr = addr; 
+  swap_req_push(p,&swap_in_req);
+  if(!SIP_PRESENT){
+    SIP_PRESENT = 1;
+    create_kernel_process("SWAP_IN_PROCESS", &SWAP_IN_PROCESS);
+  }
+  while((*pte & 0x080) && !p->killed)
+    sleep(p, &swapinlock);
+  release(&swapinlock);
+}
+
 void PGFLT_handler() {
   int addr=rcr2();
   struct proc *p = myproc();
-  acquire(&swapinlock);
-  sleep(p, &swapinlock);
   pde_t *pde = &(p->pgdir)[PDX(addr)];
   pte_t *pgtab = (pte_t*)P2V(PTE_ADDR(*pde));
 
-  if((pgtab[PTX(addr)])&0x080){
-    //This means that the page was swapped out.
-    //virtual address for page
-    // storing the address where page fault occurs. This is later used to swap in the respective file .swp file
-    p->PGFLT_addr = addr; 
-    swap_req_push(p,&swap_in_req);
-    if(!SIP_PRESENT){
-      SIP_PRESENT = 1;
-      create_kernel_process("SWAP_IN_PROCESS", &SWAP_IN_PROCESS);
-    }
+  if((*pde & PTE_P) && (pgtab[PTX(addr)])&0x080){
+    //This means that the page was swapped out. Bring it back, then
+    //retry the faulting instruction.
+    swapinpage(addr);
   } 
   else exit();
 }
@@ -48,6 +77,7 @@ tvinit(void)
   SETGATE(idt[T_SYSCALL], 1, SEG_KCODE<<3, vectors[T_SYSCALL], DPL_USER);
 
   initlock(&tickslock, "time");
+  initlock(&swapinlock, "swapin");
 }
 
 void
@@ -60,7 +90,7 @@ idtinit(void)
 void
 trap(struct trapframe *tf)
 {
-  if(tf->trapno == T_SYSCALL){
+  if(tf->trapno == T_SYSCALL || tf->trapno == T_SYSENTER){
     if(myproc()->killed)
       exit();
     myproc()->tf = tf;
@@ -75,6 +105,7 @@ trap(struct trapframe *tf)
     if(cpuid() == 0){
       acquire(&tickslock);
       ticks++;
+      vdso->ticks = ticks;
       wakeup(&ticks);
       release(&tickslock);
     }
@@ -0,0 +1,56 @@
+struct stat;
+struct rtcdate;
+struct procinfo;
+struct iostat;
+struct iovec;
+struct ioring;
+
+// system calls
+int fork(void);
+int exit(void) __attribute__((noreturn));
+int wait(void);
+int pipe(int*);
+int write(int, const void*, int);
+int read(int, void*, int);
+int close(int);
+int kill(int);
+int exec(char*, char**);
+int open(const char*, int);
+int mknod(const char*, short, short);
+int unlink(const char*);
+int fstat(int fd, struct stat*);
+int link(const char*, const char*);
+int mkdir(const char*);
+int chdir(const char*);
+int dup(int);
+int sysgetpid(void);   // getpid() and uptime() are in ulib.c
+int trapgetpid(void);  // sysgetpid() by int $T_SYSCALL
+char* sbrk(int);
+int sleep(int);
+int sysuptime(void);
+int getprocinfo(int, struct procinfo*);
+int iostat(struct iostat*);
+int splice(int, int, int);
+int readv(int, struct iovec*, int);
+int writev(int, struct iovec*, int);
+int pread(int, void*, int, int);
+int pwrite(int, void*, int, int);
+struct ioring* ioring_setup(void);
+int ioring_enter(int);
+
+// ulib.c
+int stat(const char*, struct stat*);
+char* strcpy(char*, const char*);
+void *memmove(void*, const void*, int);
+char* strchr(const char*, char c);
+int strcmp(const char*, const char*);
+void printf(int, const char*, ...);
+char* gets(char*, int max);
+uint strlen(const char*);
+void* memset(void*, int, uint);
+void* malloc(uint);
+void free(void*);
+int atoi(const char*);
+int getpid(void);
+int getcpu(void);
+int uptime(void);
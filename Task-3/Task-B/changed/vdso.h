@@ -0,0 +1,15 @@
+// vDSO: read-only pages the kernel maps into every process, so
+// that getpid(), getcpu() and uptime() in ulib.c need no system
+// call.
+
+#define VDSO      0xFDFFF000  // struct vdso, one page all processes share
+#define VDSOPROC  0x7FFFE000  // struct vdsoproc, each process's own
+
+struct vdso {
+  uint ticks;   // as uptime() returns; kept by the timer interrupt
+};
+
+struct vdsoproc {
+  int pid;
+  int cpu;      // the CPU it last ran on
+};
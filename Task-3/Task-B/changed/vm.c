@@ -7,9 +7,12 @@
 #include "proc.h"
 #include "elf.h"
 #include "spinlock.h"
+#include "vdso.h"
 
 extern char data[];  // defined by kernel.ld
+extern void sysenter(void);  // in trapasm.S
 pde_t *kpgdir;  // for use in scheduler()
+struct vdso *vdso;  // the page mapped at VDSO (see vdso.h)
 
 struct spinlock swapsleeplock;
 int swapsleepcount=0;
@@ -32,6 +35,17 @@ seginit(void)
   c->gdt[SEG_UCODE] = SEG(STA_X|STA_R, 0, 0xffffffff, DPL_USER);
   c->gdt[SEG_UDATA] = SEG(STA_W, 0, 0xffffffff, DPL_USER);
   lgdt(c->gdt, sizeof(c->gdt));
+
+  // Kernel mappings are PTE_G (see kmap), so let them stay in
+  // the TLB when %cr3 is reloaded on a process switch.
+  lcr4(rcr4() | CR4_PGE);
+
+  // System calls can come in by sysenter (see trapasm.S) as well as
+  // int $T_SYSCALL. It needs SEG_KDATA right after SEG_KCODE, and
+  // sysexit SEG_UCODE and SEG_UDATA after that; %esp is per process
+  // (see switchuvm).
+  wrmsr(MSR_SYSENTER_CS, SEG_KCODE << 3);
+  wrmsr(MSR_SYSENTER_EIP, (uint)sysenter);
 }
 
 // Return the address of the PTE in page table pgdir
@@ -106,55 +120,82 @@ mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm)
 // (directly addressable from end..P2V(PHYSTOP)).
 
 // This table defines the kernel's mappings, which are present in
-// every process's page table.
+// every process's page table. They are identical everywhere, so
+// they are marked global.
 static struct kmap {
   void *virt;
   uint phys_start;
   uint phys_end;
   int perm;
 } kmap[] = {
- { (void*)KERNBASE, 0,             EXTMEM,    PTE_W}, // I/O space
- { (void*)KERNLINK, V2P(KERNLINK), V2P(data), 0},     // kern text+rodata
- { (void*)data,     V2P(data),     PHYSTOP,   PTE_W}, // kern data+memory
- { (void*)DEVSPACE, DEVSPACE,      0,         PTE_W}, // more devices
+ { (void*)KERNBASE, 0,             EXTMEM,    PTE_W|PTE_G}, // I/O space
+ { (void*)KERNLINK, V2P(KERNLINK), V2P(data), PTE_G},       // kern text+rodata
+ { (void*)data,     V2P(data),     PHYSTOP,   PTE_W|PTE_G}, // kern data+memory
+ { (void*)DEVSPACE, DEVSPACE,      0,         PTE_W|PTE_G}, // more devices
 };
 
 // Set up kernel part of a page table.
+// The kernel's page tables are built once by kvmalloc() and shared:
+// a new page directory only copies the PDEs that point at them, so
+// fork(), exec() and create_kernel_process() no longer rebuild the
+// whole kmap[] range for every process.
 pde_t*
 setupkvm(void)
 {
   pde_t *pgdir;
-  struct kmap *k;
 
   if((pgdir = (pde_t*)kalloc()) == 0)
     return 0;
   memset(pgdir, 0, PGSIZE);
-  if (P2V(PHYSTOP) > (void*)DEVSPACE)
-    panic("PHYSTOP too high");
-  for(k = kmap; k < &kmap[NELEM(kmap)]; k++)
-    if(mappages(pgdir, k->virt, k->phys_end - k->phys_start,
-                (uint)k->phys_start, k->perm) < 0) {
-      freevm(pgdir);
-      return 0;
-    }
+  memmove(&pgdir[PDX(KERNBASE)], &kpgdir[PDX(KERNBASE)],
+          (NPDENTRIES - PDX(KERNBASE)) * sizeof(pde_t));
   return pgdir;
 }
 
 // Allocate one page table for the machine for the kernel address
-// space for scheduler processes.
+// space for scheduler processes. Its second-level page tables are
+// the ones every other page directory shares (see setupkvm).
 void
 kvmalloc(void)
 {
-  kpgdir = setupkvm();
+  struct kmap *k;
+  int i, n;
+
+  if((kpgdir = (pde_t*)kalloc()) == 0)
+    panic("kvmalloc: out of memory");
+  memset(kpgdir, 0, PGSIZE);
+  if (P2V(PHYSTOP) > (void*)DEVSPACE)
+    panic("PHYSTOP too high");
+  for(k = kmap; k < &kmap[NELEM(kmap)]; k++)
+    if(mappages(kpgdir, k->virt, k->phys_end - k->phys_start,
+                (uint)k->phys_start, k->perm) < 0)
+      panic("kvmalloc: mappages");
+
+  // The shared vDSO page, read-only to user code, goes in the kernel
+  // page tables so that every page directory has it.
+  if((vdso = (struct vdso*)kalloc()) == 0)
+    panic("kvmalloc: vdso");
+  memset(vdso, 0, PGSIZE);
+  if(mappages(kpgdir, (char*)VDSO, PGSIZE, V2P(vdso), PTE_U) < 0)
+    panic("kvmalloc: mappages vdso");
+
+  n = 0;
+  for(i = PDX(KERNBASE); i < NPDENTRIES; i++)
+    if(kpgdir[i] & PTE_P)
+      n++;
+  cprintf("kvmalloc: %d shared kernel page tables, %dKB saved per process\n",
+          n, n*PGSIZE/1024);
+
   switchkvm();
 }
 
 // Switch h/w page table register to the kernel-only page table,
-// for when no process is running.
+// for when no process is running. Nothing to do if it is loaded.
 void
 switchkvm(void)
 {
-  lcr3(V2P(kpgdir));   // switch to the kernel page table
+  if(rcr3() != V2P(kpgdir))
+    lcr3(V2P(kpgdir));   // switch to the kernel page table
 }
 
 // Switch TSS and h/w page table to correspond to process p.
@@ -174,14 +215,37 @@ switchuvm(struct proc *p)
   mycpu()->gdt[SEG_TSS].s = 0;
   mycpu()->ts.ss0 = SEG_KDATA << 3;
   mycpu()->ts.esp0 = (uint)p->kstack + KSTACKSIZE;
+  wrmsr(MSR_SYSENTER_ESP, (uint)p->kstack + KSTACKSIZE);
   // setting IOPL=0 in eflags *and* iomb beyond the tss segment limit
   // forbids I/O instructions (e.g., inb and outb) from user space
   mycpu()->ts.iomb = (ushort) 0xFFFF;
   ltr(SEG_TSS << 3);
-  lcr3(V2P(p->pgdir));  // switch to process's address space
+  // Reloading %cr3 flushes the TLB; skip it when the scheduler is
+  // still sitting on p's address space (p ran last on this CPU).
+  if(rcr3() != V2P(p->pgdir))
+    lcr3(V2P(p->pgdir));  // switch to process's address space
   popcli();
 }
 
+// Give pgdir a page of its own at VDSOPROC for process pid, read-only
+// to user code. Like the I/O ring, it goes with the page table.
+// Returns the kernel's address for it, or 0 if out of memory.
+struct vdsoproc*
+vdsomap(pde_t *pgdir, int pid)
+{
+  struct vdsoproc *v;
+
+  if((v = (struct vdsoproc*)kalloc()) == 0)
+    return 0;
+  memset(v, 0, PGSIZE);
+  v->pid = pid;
+  if(mappages(pgdir, (char*)VDSOPROC, PGSIZE, V2P(v), PTE_U) < 0){
+    kfree((char*)v);
+    return 0;
+  }
+  return v;
+}
+
 // Load the initcode into address 0 of pgdir.
 // sz must be less than a page.
 void
@@ -229,7 +293,7 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   char *mem;
   uint a;
 
-  if(newsz >= KERNBASE)
+  if(newsz > VDSOPROC)
     return 0;
   if(newsz < oldsz)
     return oldsz;
@@ -248,8 +312,10 @@ allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
       swapsleepcount++;
       release(&swapsleeplock);
       
-      swap_req_push(myproc(),&swap_out_req);
-      if(!SOP_PRESENT){
+      if(!swap_req_push(myproc(),&swap_out_req)){
+        // The swap queue is full and nobody would wake us up.
+        oom_kill();
+      } else if(!SOP_PRESENT){
         // if condition to make sure that only one SWAP_OUT_PROCESS exists at a given time.
         SOP_PRESENT = 1;
         create_kernel_process("SWAP_OUT_PROCESS", &SWAP_OUT_PROCESS);
@@ -293,6 +359,10 @@ deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
       char *v = P2V(pa);
       kfree(v);
       *pte = 0;
+    } else if(*pte & 0x080){
+      // Swapped out; release its zswap pool space, if any.
+      zswap_drop(*pte);
+      *pte = 0;
     }
   }
   return newsz;
@@ -308,7 +378,9 @@ freevm(pde_t *pgdir)
   if(pgdir == 0)
     panic("freevm: no pgdir");
   deallocuvm(pgdir, KERNBASE, 0);
-  for(i = 0; i < NPDENTRIES; i++){
+  // Only the user half owns its page tables; the kernel half
+  // points at the tables shared with kpgdir.
+  for(i = 0; i < PDX(KERNBASE); i++){
     if(pgdir[i] & PTE_P){
       char * v = P2V(PTE_ADDR(pgdir[i]));
       kfree(v);
@@ -317,6 +389,39 @@ freevm(pde_t *pgdir)
   kfree((char*)pgdir);
 }
 
+// Age the user pages of pgdir below sz for PAGE_AGING_PROCESS.
+// A page referenced since the last pass (PTE_A) gets age 0, any
+// other page one pass older, up to PTE_MAXAGE. PTE_A is cleared so
+// the next pass sees new references; pgdir should not be running,
+// or cached translations hide them. Returns the working set size: pages
+// referenced within the last WSWINDOW passes.
+int
+ageuvm(pde_t *pgdir, uint sz)
+{
+  pte_t *pte;
+  uint a, age;
+  int wss;
+
+  wss = 0;
+  for(a = 0; a < sz; a += PGSIZE){
+    pte = walkpgdir(pgdir, (char*)a, 0);
+    if(!pte){
+      a = PGADDR(PDX(a) + 1, 0, 0) - PGSIZE;
+      continue;
+    }
+    if((*pte & PTE_P) == 0 || (*pte & PTE_U) == 0)
+      continue;
+    if(*pte & PTE_A)
+      age = 0;
+    else if((age = PTE_AGE(*pte)) < PTE_MAXAGE)
+      age++;
+    *pte = (*pte & ~(PTE_A | PTE_AGEMASK)) | (age << PTE_AGESHIFT);
+    if(age < WSWINDOW)
+      wss++;
+  }
+  return wss;
+}
+
 // Clear PTE_U on a page. Used to create an inaccessible
 // page beneath the user stack.
 void
@@ -345,8 +450,15 @@ copyuvm(pde_t *pgdir, uint sz)
   for(i = 0; i < sz; i += PGSIZE){
     if((pte = walkpgdir(pgdir, (void *) i, 0)) == 0)
       panic("copyuvm: pte should exist");
-    if(!(*pte & PTE_P))
-      panic("copyuvm: page not present");
+    if(!(*pte & PTE_P)){
+      // Swapped out (see trap.c). fork() copies the current process,
+      // so bring the page back first, unless that gets us killed.
+      if(!(*pte & 0x080) || pgdir != myproc()->pgdir)
+        panic("copyuvm: page not present");
+      swapinpage(i);
+      if(!(*pte & PTE_P))
+        goto bad;
+    }
     pa = PTE_ADDR(*pte);
     flags = PTE_FLAGS(*pte);
     if((mem = kalloc()) == 0)
@@ -405,6 +517,31 @@ copyout(pde_t *pgdir, uint va, void *p, uint len)
   return 0;
 }
 
+// Copy len bytes from user address va in page table pgdir to p.
+// The counterpart of copyout.
+int
+copyin(pde_t *pgdir, void *p, uint va, uint len)
+{
+  char *buf, *pa0;
+  uint n, va0;
+
+  buf = (char*)p;
+  while(len > 0){
+    va0 = (uint)PGROUNDDOWN(va);
+    pa0 = uva2ka(pgdir, (char*)va0);
+    if(pa0 == 0)
+      return -1;
+    n = PGSIZE - (va - va0);
+    if(n > len)
+      n = len;
+    memmove(buf, pa0 + (va - va0), n);
+    len -= n;
+    buf += n;
+    va = va0 + PGSIZE;
+  }
+  return 0;
+}
+
 //PAGEBREAK!
 // Blank page.
 //PAGEBREAK!
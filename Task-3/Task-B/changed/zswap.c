@@ -0,0 +1,282 @@
+// Compressed in-memory swap cache.
+//
+// SWAP_OUT_PROCESS offers each evicted page to zswap before writing
+// it to a swap file. An all-zero page is not stored at all: its PTE
+// just gets PTE_ZERO. Any other page is compressed (LZRW1-style) into
+// a run of 128-byte chunks of one pool page, and the PTE keeps the
+// location of that run. Only pages that do not compress well, or
+// that find the pool full, go to disk.
+//
+// Pool pages are taken from the evicted pages themselves and freed
+// again once empty, so the pool costs no memory up front. It never
+// grows beyond ZPOOLPAGES pages.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "spinlock.h"
+
+#define ZCHUNK      (PGSIZE/32)   // one bit of a pool page's map
+#define ZMAXCHUNKS  24            // compressed larger than this: use disk
+#define ZHASHSIZE   4096
+
+// A handle names a run of chunks: pool page + 1, first chunk and
+// number of chunks - 1. It is never 0, which means "on disk".
+#define ZHANDLE(pg, c, n)   ((((pg)+1) << 10) | ((c) << 5) | ((n)-1))
+#define ZPAGE(h)            (((h) >> 10) - 1)
+#define ZFIRST(h)           (((h) >> 5) & 31)
+#define ZCOUNT(h)           (((h) & 31) + 1)
+
+struct {
+  struct spinlock lock;
+  struct {
+    uchar *mem;
+    uint map;                         // bit i set: chunk i in use
+  } pool[ZPOOLPAGES];
+  int npool;                          // pool pages allocated
+  uchar buf[ZMAXCHUNKS*ZCHUNK];       // compressor output
+  ushort hash[ZHASHSIZE];             // last position + 1 of a 3-byte hash
+  // Statistics, printed by zswapdump().
+  uint nzero;                         // zero pages swapped out
+  uint nstored;                       // pages compressed into the pool
+  uint nreject;                       // pages that did not compress
+  uint nfull;                         // pages that did not fit
+  uint nload;                         // pages swapped in from RAM
+  uint nchunks;                       // chunks in use
+} zswap;
+
+void
+zswapinit(void)
+{
+  initlock(&zswap.lock, "zswap");
+}
+
+// Compress the page at src into dst. Each flag byte is followed by
+// up to 8 items, a literal byte or (flag bit set) a 2-byte match
+// holding a 12-bit backward offset and a 4-bit length - 3. Returns
+// the compressed size, or -1 if it would exceed max.
+static int
+zcompress(uchar *src, uchar *dst, int max)
+{
+  int i, o, f, h, len, off;
+  uchar *flags;
+
+  memset(zswap.hash, 0, sizeof(zswap.hash));
+  i = o = 0;
+  while(i < PGSIZE){
+    if(o + 1 + 8*2 > max)
+      return -1;
+    flags = &dst[o++];
+    *flags = 0;
+    for(f = 0; f < 8 && i < PGSIZE; f++){
+      len = 0;
+      if(i + 3 <= PGSIZE){
+        h = ((src[i] << 8) ^ (src[i+1] << 4) ^ src[i+2]) & (ZHASHSIZE-1);
+        if(zswap.hash[h]){
+          off = i - (zswap.hash[h] - 1);
+          while(len < 18 && i + len < PGSIZE && src[i+len-off] == src[i+len])
+            len++;
+        }
+        zswap.hash[h] = i + 1;
+      }
+      if(len >= 3){
+        *flags |= 1 << f;
+        dst[o++] = off >> 4;
+        dst[o++] = ((off & 0xF) << 4) | (len - 3);
+        i += len;
+      } else
+        dst[o++] = src[i++];
+    }
+  }
+  return o;
+}
+
+static void
+zdecompress(uchar *src, uchar *dst)
+{
+  int i, o, f, len, off;
+  uchar flags;
+
+  i = o = 0;
+  while(o < PGSIZE){
+    flags = src[i++];
+    for(f = 0; f < 8 && o < PGSIZE; f++){
+      if(flags & (1 << f)){
+        off = (src[i] << 4) | (src[i+1] >> 4);
+        len = (src[i+1] & 0xF) + 3;
+        i += 2;
+        for(; len > 0; len--, o++)
+          dst[o] = dst[o-off];
+      } else
+        dst[o++] = src[i++];
+    }
+  }
+}
+
+static int
+iszero(char *page)
+{
+  uint *w;
+
+  for(w = (uint*)page; w < (uint*)(page + PGSIZE); w++)
+    if(*w)
+      return 0;
+  return 1;
+}
+
+// Find n free chunks in a row in map; return the first, or -1.
+static int
+findrun(uint map, int n)
+{
+  int c, k;
+
+  for(c = 0; c + n <= 32; c += k + 1){
+    for(k = 0; k < n && !(map & (1 << (c + k))); k++)
+      ;
+    if(k == n)
+      return c;
+  }
+  return -1;
+}
+
+// Try to keep the user page at page in RAM. Returns the bits to put
+// in its swapped-out PTE besides 0x080 (nonzero), after which the page
+// belongs to zswap: it is freed or becomes part of the pool. Returns
+// 0 if the page has to be written to disk; it is untouched then.
+uint
+zswap_store(char *page)
+{
+  int n, len, pg, c, free, adopted;
+  uint run;
+
+  if(iszero(page)){
+    kfree(page);
+    acquire(&zswap.lock);
+    zswap.nzero++;
+    release(&zswap.lock);
+    return PTE_ZERO;
+  }
+
+  acquire(&zswap.lock);
+  if((len = zcompress((uchar*)page, zswap.buf, sizeof(zswap.buf))) < 0){
+    zswap.nreject++;
+    release(&zswap.lock);
+    return 0;
+  }
+  n = (len + ZCHUNK - 1) / ZCHUNK;
+
+  c = -1;
+  free = -1;
+  adopted = 0;
+  for(pg = 0; pg < ZPOOLPAGES; pg++){
+    if(zswap.pool[pg].mem == 0){
+      if(free < 0)
+        free = pg;
+      continue;
+    }
+    if((c = findrun(zswap.pool[pg].map, n)) >= 0)
+      break;
+  }
+  if(c < 0){
+    if(free < 0){
+      zswap.nfull++;
+      release(&zswap.lock);
+      return 0;
+    }
+    // No room: the page itself becomes a pool page. Nothing is freed
+    // this time, but the next evictions fill it up.
+    pg = free;
+    c = 0;
+    adopted = 1;
+    zswap.pool[pg].mem = (uchar*)page;
+    zswap.pool[pg].map = 0;
+    zswap.npool++;
+  }
+
+  run = ((n == 32) ? ~0 : (1 << n) - 1) << c;
+  zswap.pool[pg].map |= run;
+  memmove(zswap.pool[pg].mem + c*ZCHUNK, zswap.buf, len);
+  zswap.nstored++;
+  zswap.nchunks += n;
+  release(&zswap.lock);
+
+  if(!adopted)
+    kfree(page);
+  return ZHANDLE(pg, c, n) << PTXSHIFT;
+}
+
+// Release the chunks of handle h. Returns the pool page if that left
+// it empty, for the caller to kfree() once zswap.lock is released.
+static char*
+zfree(uint h)
+{
+  int pg, n;
+  char *mem;
+
+  pg = ZPAGE(h);
+  n = ZCOUNT(h);
+  mem = 0;
+  zswap.pool[pg].map &= ~(((n == 32) ? ~0 : (1 << n) - 1) << ZFIRST(h));
+  zswap.nchunks -= n;
+  if(zswap.pool[pg].map == 0){
+    mem = (char*)zswap.pool[pg].mem;
+    zswap.pool[pg].mem = 0;
+    zswap.npool--;
+  }
+  return mem;
+}
+
+// Whether the page of a swapped-out PTE is in its swap file.
+int
+zswap_ondisk(uint pte)
+{
+  return !(pte & PTE_ZERO) && PTE_ZSLOT(pte) == 0;
+}
+
+// Bring the page of a swapped-out PTE that is not on disk back into
+// mem, and release its pool space.
+void
+zswap_load(uint pte, char *mem)
+{
+  uint h;
+  char *empty;
+
+  if(pte & PTE_ZERO){
+    memset(mem, 0, PGSIZE);
+    return;
+  }
+  h = PTE_ZSLOT(pte);
+  acquire(&zswap.lock);
+  zdecompress(zswap.pool[ZPAGE(h)].mem + ZFIRST(h)*ZCHUNK, (uchar*)mem);
+  zswap.nload++;
+  empty = zfree(h);
+  release(&zswap.lock);
+  if(empty)
+    kfree(empty);
+}
+
+// Drop a swapped-out page that is not needed any more.
+void
+zswap_drop(uint pte)
+{
+  char *empty;
+
+  if(pte & PTE_ZERO || PTE_ZSLOT(pte) == 0)
+    return;
+  acquire(&zswap.lock);
+  empty = zfree(PTE_ZSLOT(pte));
+  release(&zswap.lock);
+  if(empty)
+    kfree(empty);
+}
+
+void
+zswapdump(void)
+{
+  cprintf("zswap: %d zero, %d stored, %d rejected, %d full, %d loaded; "
+          "pool %d pages, %d/%d chunks used\n",
+          zswap.nzero, zswap.nstored, zswap.nreject, zswap.nfull,
+          zswap.nload, zswap.npool, zswap.nchunks, zswap.npool*32);
+}